@@ -0,0 +1,190 @@
+//--------------------------------------------------------------------------
+//                                INIASYNC.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INIAsync.cpp
+//! \brief Functions for opening INI files in the background
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#pragma hdrstop
+
+#include "INIAsync.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              PUBLIC FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INIOpenTask class
+//! \return   an instance of the class
+//!
+//! The task is pending until it is finished by the parser.
+//!
+//--------------------------------------------------------------------------
+__CALL INIOpenTask::INIOpenTask()
+{
+	this->State = make_shared<state>();
+	this->State->Cancelled.store(false);
+	this->State->Started = false;
+	this->State->Status = INI_OPEN_PENDING;
+	this->State->Error = 0;
+	this->Future = this->State->Promise.get_future().share();
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Cancel the opening
+//!
+//! If the file has not been parsed yet, the task ends with the status
+//! INI_OPEN_CANCELLED: the parser is left as it was if the executor has
+//! not started the task, and without file otherwise. Once the file is
+//! parsed, this function has no effect.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIOpenTask::Cancel()
+{
+	this->State->Cancelled.store(true);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the status of the opening
+//! \return   the status (see INIOpenStatus)
+//!
+//--------------------------------------------------------------------------
+INIOpenStatus __CALL INIOpenTask::GetStatus() const
+{
+	lock_guard<mutex> Guard(this->State->Lock);
+
+	return this->State->Status;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the error of the opening
+//! \return   the errno value of a failed opening (0 otherwise)
+//!
+//--------------------------------------------------------------------------
+int __CALL INIOpenTask::GetError() const
+{
+	lock_guard<mutex> Guard(this->State->Lock);
+
+	return this->State->Error;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the future of the opening
+//! \return   a future which is ready with the status once the task is done
+//!
+//--------------------------------------------------------------------------
+shared_future<INIOpenStatus> __CALL INIOpenTask::GetFuture() const
+{
+	return this->Future;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Wait for the end of the opening
+//! \return   the status of the task once it is done
+//!
+//--------------------------------------------------------------------------
+INIOpenStatus __CALL INIOpenTask::Wait() const
+{
+	return this->Future.get();
+}
+
+//--------------------------------------------------------------------------
+//                              PRIVATE FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    End a task
+//! \param    S        the state of the task
+//! \param    Status   the status of the task
+//! \param    Error    the errno value of a failed opening
+//!
+//! This function is for local using only. The future is made ready, then
+//! the awaiting coroutine (if any) is resumed. A task which is already done
+//! is left as it is.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIOpenTask::Finish(state &S, INIOpenStatus Status, int Error)
+{
+	function<void()> Continuation;
+	{
+		lock_guard<mutex> Guard(S.Lock);
+		if(S.Status != INI_OPEN_PENDING)
+			return;
+		S.Status = Status;
+		S.Error = Error;
+		Continuation.swap(S.Continuation);
+	}
+
+	S.Promise.set_value(Status);
+	if(Continuation)
+		Continuation();
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Start a task
+//! \param    S   the state of the task
+//! \return   a boolean. true if the file can be opened, false if the task
+//!           has been cancelled
+//!
+//! This function is for local using only. It is called by the executor
+//! before the parser is used: a task which is not cancelled at this point
+//! is started, and the parser waits for it (see Abandon()).
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIOpenTask::Start(state &S)
+{
+	lock_guard<mutex> Guard(S.Lock);
+	if(S.Cancelled.load())
+		return false;
+	S.Started = true;
+
+	return true;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Cancel a task for the parser
+//! \return   a boolean. true if the task is done, false if the executor
+//!           has started it and the parser must wait for it
+//!
+//! This function is for local using only. A task which is not started yet
+//! is cancelled at once: when the executor runs it later, it does not use
+//! the parser anymore. So the parser does not wait for an executor which
+//! may be run by the destroying thread itself (e.g. an event loop).
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIOpenTask::Abandon()
+{
+	bool Started;
+	{
+		lock_guard<mutex> Guard(this->State->Lock);
+		this->State->Cancelled.store(true);
+		Started = this->State->Started;
+	}
+	if(Started)
+		return false;
+
+	INIOpenTask::Finish(*this->State, INI_OPEN_CANCELLED, 0);
+	return true;
+}
@@ -0,0 +1,115 @@
+//--------------------------------------------------------------------------
+//                                INIASYNC.H
+//--------------------------------------------------------------------------
+//!
+//! \file INIAsync.h
+//! \brief Header file for opening INI files in the background
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INIAsyncH
+#define INIAsyncH
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+
+// the tasks can be awaited by the C++20 coroutines
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#include <coroutine>
+#define INI_COROUTINES 1
+#endif
+
+#include "INIParser.h"
+
+//--------------------------------------------------------------------------
+//                              STRUCTURES DECLARATIONS
+//--------------------------------------------------------------------------
+
+//! \brief status of an INIOpenTask
+enum INIOpenStatus
+{
+	//! \brief the file is being opened
+	INI_OPEN_PENDING = 0,
+	//! \brief the file is opened
+	INI_OPEN_DONE = 1,
+	//! \brief the file cannot be opened (see INIOpenTask::GetError())
+	INI_OPEN_FAILED = 2,
+	//! \brief the task has been cancelled before the file was parsed
+	INI_OPEN_CANCELLED = 3
+};
+
+//--------------------------------------------------------------------------
+//                              INIOPENTASK CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INIOpenTask
+//! \brief INIOpenTask class.
+//!
+//! This class follows the opening of an INI file by INIParser::OpenAsync().
+//! The result is given by a future (GetFuture()), or by co_await in a C++20
+//! coroutine, which is resumed by the thread which opened the file (only one
+//! coroutine can await a task). The copies of a task refer to the same
+//! opening, and destroying them does not wait for it: the parser must not
+//! be used until the task is done. Destroying the parser cancels the task,
+//! and waits for it only if the executor has already started it.
+//!
+//--------------------------------------------------------------------------
+class INIOpenTask
+{
+	private:
+		struct state
+		{
+			std::atomic<bool> Cancelled;
+			std::mutex Lock;
+			bool Started;
+			INIOpenStatus Status;
+			int Error;
+			std::promise<INIOpenStatus> Promise;
+			std::function<void()> Continuation;
+		};
+
+		std::shared_ptr<state> State;
+		std::shared_future<INIOpenStatus> Future;
+
+		static void __CALL Finish(state &S, INIOpenStatus Status, int Error);
+		static bool __CALL Start(state &S);
+		bool __CALL Abandon();
+
+	public:
+		__CALL INIOpenTask();
+
+		void __CALL Cancel();
+		INIOpenStatus __CALL GetStatus() const;
+		int __CALL GetError() const;
+		std::shared_future<INIOpenStatus> __CALL GetFuture() const;
+		INIOpenStatus __CALL Wait() const;
+
+#ifdef INI_COROUTINES
+		bool await_ready() const { return this->GetStatus() != INI_OPEN_PENDING; }
+		bool await_suspend(std::coroutine_handle<> Handle)
+		{
+			std::lock_guard<std::mutex> Guard(this->State->Lock);
+			if(this->State->Status != INI_OPEN_PENDING)
+				return false;
+			this->State->Continuation = [Handle]() { Handle.resume(); };
+			return true;
+		}
+		INIOpenStatus await_resume() const { return this->GetStatus(); }
+#endif
+
+		friend class INIParser;
+};
+
+#endif
@@ -0,0 +1,278 @@
+//--------------------------------------------------------------------------
+//                                INICACHE.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INICache.cpp
+//! \brief Functions for the cache of the parsed INI files of the process
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#include <sys/stat.h>
+
+#pragma hdrstop
+
+#include "INICache.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              LOCAL FUNCTIONS
+//--------------------------------------------------------------------------
+
+namespace
+{
+
+//--------------------------------------------------------------------------
+// Modification time of a file in nanoseconds
+int64_t ModificationTime(const struct stat &st)
+{
+#if __linux__
+	return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+	return (int64_t)st.st_mtime * 1000000000;
+#endif
+}
+
+//--------------------------------------------------------------------------
+// Check that a file is still the one described by st
+bool SameFile(const struct stat &st, uint64_t device, uint64_t inode, uint64_t size, int64_t time)
+{
+	return (uint64_t)st.st_dev == device && (uint64_t)st.st_ino == inode
+		&& (uint64_t)st.st_size == size && ModificationTime(st) == time;
+}
+
+}
+
+//--------------------------------------------------------------------------
+//                              PUBLIC FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INICache class
+//! \param    Budget   the size of the snapshots kept by the cache, in bytes
+//! \return   an instance of the class
+//!
+//--------------------------------------------------------------------------
+__CALL INICache::INICache(size_t Budget)
+{
+	this->Budget = Budget;
+	this->Size = 0;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the cache of the process
+//! \return   the cache shared by all the parts of the program
+//!
+//! The cache is created by the first call (with a budget of 64 MB), and
+//! lives until the end of the process.
+//!
+//--------------------------------------------------------------------------
+INICache & __CALL INICache::Global()
+{
+	static INICache *Cache = new INICache();
+
+	return *Cache;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Open an INI file through the cache
+//! \param    File   the INI file to open
+//! \return   the snapshot of the file (NULL if it cannot be opened or if
+//!           its snapshot would be larger than 4 GB)
+//!
+//! If the file has not changed since it was cached, its snapshot is
+//! returned at once. Otherwise the file is parsed (mapped, see INI_MAPPED)
+//! without holding the lock of the cache, and its snapshot replaces the
+//! previous one. A file modified while it is parsed is not cached. A
+//! snapshot larger than the budget is returned but not cached.
+//!
+//--------------------------------------------------------------------------
+shared_ptr<const INISnapshot> __CALL INICache::Open(const char *File)
+{
+	struct stat st;
+	if(stat(File, &st) != 0)
+	{
+		this->Remove(File);
+		return NULL;
+	}
+
+	string Path(File);
+	{
+		lock_guard<mutex> Guard(this->Lock);
+		unordered_map<string, list<entry>::iterator>::iterator f = this->Paths.find(Path);
+		if(f != this->Paths.end())
+		{
+			list<entry>::iterator e = f->second;
+			if(SameFile(st, e->device, e->inode, e->size, e->time))
+			{
+				this->Entries.splice(this->Entries.begin(), this->Entries, e);
+				return e->snapshot;
+			}
+			this->Erase(e);
+		}
+	}
+
+	INIParser Parser;
+	if(!Parser.Open(File, INI_MAPPED))
+		return NULL;
+	shared_ptr<const INISnapshot> s(new INISnapshot(Parser, 0));
+	if(!s->IsValid())
+		return NULL;
+
+	struct stat after;
+	if(stat(File, &after) != 0 || !SameFile(after, st.st_dev, st.st_ino, st.st_size, ModificationTime(st)))
+		return s;
+
+	lock_guard<mutex> Guard(this->Lock);
+	if(s->Size() > this->Budget)
+		return s;
+
+	// another thread may have cached the file in the meantime
+	unordered_map<string, list<entry>::iterator>::iterator f = this->Paths.find(Path);
+	if(f != this->Paths.end())
+		this->Erase(f->second);
+
+	entry e;
+	e.path = Path;
+	e.device = st.st_dev;
+	e.inode = st.st_ino;
+	e.size = st.st_size;
+	e.time = ModificationTime(st);
+	e.snapshot = s;
+	this->Entries.push_front(e);
+	this->Paths[Path] = this->Entries.begin();
+	this->Size += s->Size();
+	this->Trim();
+
+	return s;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Remove an INI file from the cache
+//! \param    File   the INI file to remove
+//!
+//! The snapshot is released once it is not used anymore.
+//!
+//--------------------------------------------------------------------------
+void __CALL INICache::Remove(const char *File)
+{
+	lock_guard<mutex> Guard(this->Lock);
+
+	unordered_map<string, list<entry>::iterator>::iterator f = this->Paths.find(File);
+	if(f != this->Paths.end())
+		this->Erase(f->second);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Remove every INI file from the cache
+//!
+//--------------------------------------------------------------------------
+void __CALL INICache::Clear()
+{
+	lock_guard<mutex> Guard(this->Lock);
+
+	this->Paths.clear();
+	this->Entries.clear();
+	this->Size = 0;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Set the budget of the cache
+//! \param    Budget   the size of the snapshots kept by the cache, in bytes
+//!
+//! The least recently opened files are removed until the cache fits.
+//!
+//--------------------------------------------------------------------------
+void __CALL INICache::SetBudget(size_t Budget)
+{
+	lock_guard<mutex> Guard(this->Lock);
+
+	this->Budget = Budget;
+	this->Trim();
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the budget of the cache
+//! \return   the size of the snapshots the cache can keep, in bytes
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INICache::GetBudget()
+{
+	lock_guard<mutex> Guard(this->Lock);
+
+	return this->Budget;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the number of files of the cache
+//! \return   the number of snapshots kept by the cache
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INICache::GetCount()
+{
+	lock_guard<mutex> Guard(this->Lock);
+
+	return this->Entries.size();
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the size of the cache
+//! \return   the size of the snapshots kept by the cache, in bytes
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INICache::GetSize()
+{
+	lock_guard<mutex> Guard(this->Lock);
+
+	return this->Size;
+}
+
+//--------------------------------------------------------------------------
+//                              PRIVATE FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Remove an entry of the cache
+//! \param    e   the entry
+//!
+//! This function is for local using only. The lock must be held.
+//!
+//--------------------------------------------------------------------------
+void __CALL INICache::Erase(list<entry>::iterator e)
+{
+	this->Size -= e->snapshot->Size();
+	this->Paths.erase(e->path);
+	this->Entries.erase(e);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Remove the least recently opened entries over the budget
+//!
+//! This function is for local using only. The lock must be held.
+//!
+//--------------------------------------------------------------------------
+void __CALL INICache::Trim()
+{
+	while(this->Size > this->Budget && !this->Entries.empty())
+		this->Erase(prev(this->Entries.end()));
+}
@@ -0,0 +1,85 @@
+//--------------------------------------------------------------------------
+//                                INICACHE.H
+//--------------------------------------------------------------------------
+//!
+//! \file INICache.h
+//! \brief Header file for the cache of the parsed INI files of the process
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INICacheH
+#define INICacheH
+
+#include <stdint.h>
+#include <string>
+#include <list>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+#include "INISnapshot.h"
+
+//--------------------------------------------------------------------------
+//                              INICACHE CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INICache
+//! \brief INICache class.
+//!
+//! This class keeps the snapshots of the INI files opened by Open(), so the
+//! parts of a program opening the same file share one parsed copy. A file
+//! is parsed again only when its device, inode, size or modification time
+//! has changed: otherwise opening it costs one stat().
+//! The snapshots are shared pointers, so a snapshot removed from the cache
+//! lives as long as it is used. When the size of the cached snapshots goes
+//! over the budget, the least recently opened ones are removed first.
+//! The cache can be used by several threads at once.
+//!
+//--------------------------------------------------------------------------
+class INICache
+{
+	private:
+		struct entry
+		{
+			std::string path;
+			uint64_t device;
+			uint64_t inode;
+			uint64_t size;
+			int64_t time;
+			std::shared_ptr<const INISnapshot> snapshot;
+		};
+
+		std::mutex Lock;
+		std::list<entry> Entries;
+		std::unordered_map<std::string, std::list<entry>::iterator> Paths;
+		std::size_t Budget;
+		std::size_t Size;
+
+		void __CALL Erase(std::list<entry>::iterator e);
+		void __CALL Trim();
+
+	public:
+		__CALL INICache(std::size_t Budget=64 * 1024 * 1024);
+		INICache(const INICache &) = delete;
+		INICache &operator=(const INICache &) = delete;
+
+		static INICache & __CALL Global();
+		std::shared_ptr<const INISnapshot> __CALL Open(const char *File);
+		void __CALL Remove(const char *File);
+		void __CALL Clear();
+		void __CALL SetBudget(std::size_t Budget);
+		std::size_t __CALL GetBudget();
+		std::size_t __CALL GetCount();
+		std::size_t __CALL GetSize();
+};
+
+#endif
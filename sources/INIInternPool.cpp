@@ -0,0 +1,182 @@
+//--------------------------------------------------------------------------
+//                                ININTERNPOOL.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INIInternPool.cpp
+//! \brief Functions for the pool of the names shared by the parsers
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#include <string.h>
+#include <functional>
+
+#pragma hdrstop
+
+#include "INIInternPool.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              PUBLIC FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INIInternPool class
+//! \return   an instance of the class
+//!
+//--------------------------------------------------------------------------
+__CALL INIInternPool::INIInternPool()
+{
+	for(int i = 0; i < ShardCount; i++)
+		this->Shards[i].Size = 0;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the pool of the process
+//! \return   the pool shared by all the parsers (see INI_INTERN)
+//!
+//! The pool is created by the first call, and lives until the end of the
+//! process.
+//!
+//--------------------------------------------------------------------------
+INIInternPool & __CALL INIInternPool::Global()
+{
+	static INIInternPool *Pool = new INIInternPool();
+
+	return *Pool;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Intern a name
+//! \param    name   the name to intern
+//! \return   the copy of the name kept by the pool
+//!
+//! The name is copied the first time only, the next calls with an equal
+//! name return the same view. Every call must be followed by a call of
+//! Release() once the name is no longer used.
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INIInternPool::Acquire(string_view name)
+{
+	shard &S = this->Shard(name);
+	lock_guard<mutex> Guard(S.Lock);
+
+	unordered_map<string_view, internname>::iterator f = S.Names.find(name);
+	if(f != S.Names.end())
+	{
+		f->second.refs++;
+		return f->first;
+	}
+
+	internname n;
+	n.text.reset(new char[name.size() + 1]);
+	if(name.size() > 0)
+		memcpy(n.text.get(), name.data(), name.size());
+	n.text[name.size()] = '\0';
+	n.refs = 1;
+
+	string_view v(n.text.get(), name.size());
+	S.Names.emplace(v, move(n));
+	S.Size += name.size();
+	return v;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Release a name
+//! \param    name   the name given by Acquire() (or an equal name)
+//!
+//! The name is freed when it has been released as many times as it has
+//! been acquired, its views are then invalid.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIInternPool::Release(string_view name)
+{
+	shard &S = this->Shard(name);
+	lock_guard<mutex> Guard(S.Lock);
+
+	unordered_map<string_view, internname>::iterator f = S.Names.find(name);
+	if(f == S.Names.end() || --(f->second.refs) > 0)
+		return;
+
+	S.Size -= name.size();
+	S.Names.erase(f);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Find an interned name
+//! \param    name   the name to find
+//! \return   the view kept by the pool, or name if it is not interned
+//!
+//! A name found in the pool is compared by its address by the parsers
+//! opened with the INI_INTERN flag. The view is valid while a parser holds
+//! the name, i.e. while a file declaring it is opened.
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INIInternPool::Find(string_view name)
+{
+	shard &S = this->Shard(name);
+	lock_guard<mutex> Guard(S.Lock);
+
+	unordered_map<string_view, internname>::iterator f = S.Names.find(name);
+	if(f == S.Names.end())
+		return name;
+
+	return f->first;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the number of names of the pool
+//! \return   the number of different names held by the parsers
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INIInternPool::GetCount()
+{
+	size_t n = 0;
+	for(int i = 0; i < ShardCount; i++)
+	{
+		lock_guard<mutex> Guard(this->Shards[i].Lock);
+		n += this->Shards[i].Names.size();
+	}
+
+	return n;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the size of the names of the pool
+//! \return   the number of characters of the different names held
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INIInternPool::GetSize()
+{
+	size_t n = 0;
+	for(int i = 0; i < ShardCount; i++)
+	{
+		lock_guard<mutex> Guard(this->Shards[i].Lock);
+		n += this->Shards[i].Size;
+	}
+
+	return n;
+}
+
+// --------------------------------------------------------------------------
+// Shard of a name
+INIInternPool::shard & __CALL INIInternPool::Shard(string_view name)
+{
+	return this->Shards[(hash<string_view>()(name) >> 7) % ShardCount];
+}
@@ -0,0 +1,83 @@
+//--------------------------------------------------------------------------
+//                                ININTERNPOOL.H
+//--------------------------------------------------------------------------
+//!
+//! \file INIInternPool.h
+//! \brief Header file for the pool of the names shared by the parsers
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INIInternPoolH
+#define INIInternPoolH
+
+#include <cstddef>
+#include <string_view>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
+
+#include "INIParser.h"
+
+//--------------------------------------------------------------------------
+//                              INIINTERNPOOL CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INIInternPool
+//! \brief INIInternPool class.
+//!
+//! This class keeps one copy of the names given to Acquire(), so the equal
+//! names of all the parsers are the same view and are compared by their
+//! address (see INISameName()). Every name counts its references: it is
+//! freed when the last parser holding it releases it, so the pool only
+//! keeps the names of the opened files. The pool can be used by several
+//! threads at once, the names are spread over shards which have their own
+//! lock.
+//!
+//! The parsers opened with the INI_INTERN flag keep their section and
+//! parameter names in the pool of the process, returned by Global().
+//!
+//--------------------------------------------------------------------------
+class INIInternPool
+{
+	private:
+		struct internname
+		{
+			std::unique_ptr<char[]> text;
+			std::size_t refs;
+		};
+
+		struct shard
+		{
+			std::mutex Lock;
+			std::unordered_map<std::string_view, internname> Names;
+			std::size_t Size;
+		};
+
+		static const int ShardCount = 16;
+		shard Shards[ShardCount];
+
+		shard & __CALL Shard(std::string_view name);
+
+	public:
+		__CALL INIInternPool();
+		INIInternPool(const INIInternPool &) = delete;
+		INIInternPool &operator=(const INIInternPool &) = delete;
+
+		static INIInternPool & __CALL Global();
+		std::string_view __CALL Acquire(std::string_view name);
+		void __CALL Release(std::string_view name);
+		std::string_view __CALL Find(std::string_view name);
+		std::size_t __CALL GetCount();
+		std::size_t __CALL GetSize();
+};
+
+#endif
@@ -0,0 +1,447 @@
+//--------------------------------------------------------------------------
+//                                INILINETABLE.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INILineTable.cpp
+//! \brief Functions for the ordered table of the lines of an INI file
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#pragma hdrstop
+
+#include "INILineTable.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              PUBLIC FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INILineTable class
+//! \param    Memory   the memory resource of the nodes
+//!
+//--------------------------------------------------------------------------
+INILineTable::INILineTable(pmr::memory_resource *Memory) :
+	Nodes(Memory), Spine(Memory), Free(Memory)
+{
+	this->Root = -1;
+	this->Building = true;
+	this->Seed = 2463534242U;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Remove all the lines
+//!
+//! The memory of the nodes is given back to the memory resource.
+//!
+//--------------------------------------------------------------------------
+void INILineTable::Clear()
+{
+	pmr::vector<linenode>(this->Nodes.get_allocator()).swap(this->Nodes);
+	pmr::vector<int>(this->Spine.get_allocator()).swap(this->Spine);
+	pmr::vector<int>(this->Free.get_allocator()).swap(this->Free);
+	this->Root = -1;
+	this->Building = true;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Reserve the memory for a number of lines
+//! \param    n   the number of lines
+//!
+//--------------------------------------------------------------------------
+void INILineTable::Reserve(size_t n)
+{
+	this->Nodes.reserve(n);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the number of lines
+//! \return   the number of lines of the table
+//!
+//--------------------------------------------------------------------------
+unsigned int INILineTable::Count()
+{
+	if(this->Building)
+		return this->Nodes.size();
+	return this->Size(this->Root);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the end of the handles
+//! \return   a number greater than every handle
+//!
+//! The handles from 0 to End() - 1 can be read in any order, faster than
+//! by walking the lines, but some of them may be erased lines.
+//!
+//--------------------------------------------------------------------------
+int INILineTable::End()
+{
+	return this->Nodes.size();
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Add a line at the end of the table
+//! \param    line   the line to add
+//! \return   the handle of the new line
+//!
+//! While the table is filled by Append() only, the tree is built in linear
+//! time from its right spine (the sizes of the subtrees are computed by the
+//! first call which needs them). Once the table has been modified, this
+//! function is the same as Insert(Count(), line).
+//!
+//--------------------------------------------------------------------------
+int INILineTable::Append(const lineview &line)
+{
+	if(!this->Building)
+		return this->Insert(this->Count(), line);
+
+	int n = this->NewNode(line);
+	linenode &N = this->Nodes[n];
+
+	// the nodes of the spine with a lower priority become the left subtree
+	int last = -1;
+	while(!this->Spine.empty() && this->Nodes[this->Spine.back()].priority < N.priority)
+	{
+		last = this->Spine.back();
+		this->Spine.pop_back();
+	}
+
+	N.left = last;
+	if(last >= 0)
+		this->Nodes[last].parent = n;
+
+	if(this->Spine.empty())
+	{
+		this->Root = n;
+	}
+	else
+	{
+		this->Nodes[this->Spine.back()].right = n;
+		N.parent = this->Spine.back();
+	}
+	this->Spine.push_back(n);
+
+	return n;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Insert a line
+//! \param    pos    the line number of the new line (0 for the first line)
+//! \param    line   the line to insert
+//! \return   the handle of the new line
+//!
+//! The lines from pos are moved one line down in O(log n).
+//!
+//--------------------------------------------------------------------------
+int INILineTable::Insert(unsigned int pos, const lineview &line)
+{
+	this->Resize(-1);
+	if(pos > this->Count())
+		pos = this->Count();
+
+	int n = this->NewNode(line);
+	int a, b;
+	this->Split(this->Root, pos, a, b);
+	this->Root = this->Merge(this->Merge(a, n), b);
+	this->Nodes[this->Root].parent = -1;
+
+	return n;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Insert a line after another one
+//! \param    handle   the handle of the previous line (-1 to insert at the beginning)
+//! \param    line     the line to insert
+//! \return   the handle of the new line
+//!
+//--------------------------------------------------------------------------
+int INILineTable::InsertAfter(int handle, const lineview &line)
+{
+	if(handle < 0)
+		return this->Insert(0, line);
+
+	return this->Insert(this->Line(handle) + 1, line);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Erase lines
+//! \param    pos     the line number of the first line to erase
+//! \param    count   the number of lines to erase
+//!
+//! The lines after the erased ones are moved up in O(log n). The handles of
+//! the erased lines are not valid anymore.
+//!
+//--------------------------------------------------------------------------
+void INILineTable::Erase(unsigned int pos, unsigned int count)
+{
+	this->Resize(-1);
+	if(count == 0 || pos >= this->Count())
+		return;
+
+	int a, b, c;
+	this->Split(this->Root, pos, a, b);
+	this->Split(b, count, b, c);
+	this->Root = this->Merge(a, c);
+	if(this->Root >= 0)
+		this->Nodes[this->Root].parent = -1;
+
+	// the nodes of the erased subtree are kept for the next insertions
+	size_t first = this->Free.size();
+	if(b >= 0)
+		this->Free.push_back(b);
+	for(size_t i = first; i < this->Free.size(); i++)
+	{
+		const linenode &N = this->Nodes[this->Free[i]];
+		if(N.left >= 0)
+			this->Free.push_back(N.left);
+		if(N.right >= 0)
+			this->Free.push_back(N.right);
+	}
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the line number of a line
+//! \param    handle   the handle of the line
+//! \return   the line number (0 for the first line)
+//!
+//--------------------------------------------------------------------------
+unsigned int INILineTable::Line(int handle)
+{
+	this->Resize(-1);
+
+	unsigned int r = this->Size(this->Nodes[handle].left);
+	int t = handle;
+	for(int p = this->Nodes[t].parent; p >= 0; p = this->Nodes[t].parent)
+	{
+		if(this->Nodes[p].right == t)
+			r += this->Size(this->Nodes[p].left) + 1;
+		t = p;
+	}
+
+	return r;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the line at a line number
+//! \param    pos   the line number (0 for the first line)
+//! \return   the handle of the line (-1 if pos is out of the table)
+//!
+//--------------------------------------------------------------------------
+int INILineTable::At(unsigned int pos)
+{
+	this->Resize(-1);
+
+	int t = this->Root;
+	while(t >= 0)
+	{
+		unsigned int l = this->Size(this->Nodes[t].left);
+		if(pos == l)
+			return t;
+		if(pos < l)
+		{
+			t = this->Nodes[t].left;
+		}
+		else
+		{
+			pos -= l + 1;
+			t = this->Nodes[t].right;
+		}
+	}
+
+	return -1;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the first line
+//! \return   the handle of the first line (-1 if the table is empty)
+//!
+//--------------------------------------------------------------------------
+int INILineTable::First()
+{
+	int t = this->Root;
+	if(t < 0)
+		return -1;
+
+	while(this->Nodes[t].left >= 0)
+		t = this->Nodes[t].left;
+	return t;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the next line
+//! \param    handle   the handle of a line
+//! \return   the handle of the next line (-1 after the last line)
+//!
+//! Walking the whole table with First() and Next() takes a linear time.
+//!
+//--------------------------------------------------------------------------
+int INILineTable::Next(int handle)
+{
+	int t = this->Nodes[handle].right;
+	if(t >= 0)
+	{
+		while(this->Nodes[t].left >= 0)
+			t = this->Nodes[t].left;
+		return t;
+	}
+
+	t = handle;
+	int p = this->Nodes[t].parent;
+	while(p >= 0 && this->Nodes[p].right == t)
+	{
+		t = p;
+		p = this->Nodes[t].parent;
+	}
+	return p;
+}
+
+//--------------------------------------------------------------------------
+//                              PRIVATE FUNCTIONS
+//--------------------------------------------------------------------------
+
+// --------------------------------------------------------------------------
+// Random priorities (xorshift), the same for every run
+unsigned int INILineTable::Random()
+{
+	unsigned int x = this->Seed;
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	this->Seed = x;
+	return x;
+}
+
+// --------------------------------------------------------------------------
+// Compute the sizes of the subtree 't' built by Append(). With t = -1, the
+// whole tree is computed once when the building ends.
+unsigned int INILineTable::Resize(int t)
+{
+	if(t < 0)
+	{
+		if(!this->Building)
+			return 0;
+		this->Building = false;
+		pmr::vector<int>(this->Spine.get_allocator()).swap(this->Spine);
+		return (this->Root < 0) ? 0 : this->Resize(this->Root);
+	}
+
+	linenode &N = this->Nodes[t];
+	N.size = 1;
+	if(N.left >= 0)
+		N.size += this->Resize(N.left);
+	if(N.right >= 0)
+		N.size += this->Resize(N.right);
+	return N.size;
+}
+
+// --------------------------------------------------------------------------
+// Create a node which is not linked to the tree (an erased node is reused)
+int INILineTable::NewNode(const lineview &line)
+{
+	linenode N;
+	N.line = line;
+	N.left = -1;
+	N.right = -1;
+	N.parent = -1;
+	N.size = 1;
+	N.priority = this->Random();
+
+	if(!this->Free.empty())
+	{
+		int n = this->Free.back();
+		this->Free.pop_back();
+		this->Nodes[n] = N;
+		return n;
+	}
+
+	this->Nodes.push_back(N);
+	return this->Nodes.size() - 1;
+}
+
+// --------------------------------------------------------------------------
+// Split the subtree 't' into 'a' (its first 'pos' lines) and 'b' (the others)
+void INILineTable::Split(int t, unsigned int pos, int &a, int &b)
+{
+	if(t < 0)
+	{
+		a = -1;
+		b = -1;
+		return;
+	}
+
+	linenode &N = this->Nodes[t];
+	unsigned int l = this->Size(N.left);
+	if(l < pos)
+	{
+		int r;
+		this->Split(N.right, pos - l - 1, r, b);
+		N.right = r;
+		if(r >= 0)
+			this->Nodes[r].parent = t;
+		if(b >= 0)
+			this->Nodes[b].parent = -1;
+		a = t;
+	}
+	else
+	{
+		int r;
+		this->Split(N.left, pos, a, r);
+		N.left = r;
+		if(r >= 0)
+			this->Nodes[r].parent = t;
+		if(a >= 0)
+			this->Nodes[a].parent = -1;
+		b = t;
+	}
+	N.size = this->Size(N.left) + this->Size(N.right) + 1;
+}
+
+// --------------------------------------------------------------------------
+// Merge the subtrees 'a' and 'b' (the lines of 'a' are before those of 'b')
+int INILineTable::Merge(int a, int b)
+{
+	if(a < 0)
+		return b;
+	if(b < 0)
+		return a;
+
+	if(this->Nodes[a].priority > this->Nodes[b].priority)
+	{
+		int r = this->Merge(this->Nodes[a].right, b);
+		linenode &N = this->Nodes[a];
+		N.right = r;
+		this->Nodes[r].parent = a;
+		N.size = this->Size(N.left) + this->Size(N.right) + 1;
+		return a;
+	}
+
+	int l = this->Merge(a, this->Nodes[b].left);
+	linenode &N = this->Nodes[b];
+	N.left = l;
+	this->Nodes[l].parent = b;
+	N.size = this->Size(N.left) + this->Size(N.right) + 1;
+	return b;
+}
@@ -0,0 +1,113 @@
+//--------------------------------------------------------------------------
+//                                INILINETABLE.H
+//--------------------------------------------------------------------------
+//!
+//! \file INILineTable.h
+//! \brief Header file for the ordered table of the lines of an INI file
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INILineTableH
+#define INILineTableH
+
+#include <string_view>
+#include <vector>
+#include <memory_resource>
+
+//--------------------------------------------------------------------------
+//                              STRUCTURES DECLARATIONS
+//--------------------------------------------------------------------------
+
+//! \brief structure for a line of the parser index
+struct lineview
+{
+	//! \brief the type of the line (0 : comment, 1 : key or parameter, 2 : key or parameter with comment)
+	int type;
+	//! \brief the comment of the line, with its '#' or ';' (the whole line for a comment line)
+	std::string_view text;
+	//! \brief the index of the section of the line (-1 for a comment line)
+	int sec;
+	//! \brief the index of the parameter of the line (-1 for a comment or section line)
+	int param;
+};
+
+//! \brief structure for a node of the line table
+struct linenode
+{
+	//! \brief the line
+	lineview line;
+	//! \brief the handle of the left child (-1 if none)
+	int left;
+	//! \brief the handle of the right child (-1 if none)
+	int right;
+	//! \brief the handle of the parent (-1 for the root)
+	int parent;
+	//! \brief the number of lines in the subtree of this node
+	unsigned int size;
+	//! \brief the random priority of the node (a parent has a greater priority than its children)
+	unsigned int priority;
+};
+
+//--------------------------------------------------------------------------
+//                              INILINETABLE CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INILineTable
+//! \brief INILineTable class.
+//!
+//! This class keeps the lines of an INI file in order. The lines are the
+//! nodes of a randomized balanced tree (treap) ordered by their position,
+//! so a line is inserted anywhere in O(log n) and its line number is
+//! computed in O(log n) from its rank in the tree.
+//!
+//! A line is known by its handle, which never changes: the lines after an
+//! inserted or erased line are moved without updating anything. The handles
+//! of erased lines are reused by the next inserted lines.
+//!
+//--------------------------------------------------------------------------
+class INILineTable
+{
+	private:
+		std::pmr::vector<linenode> Nodes;
+		std::pmr::vector<int> Spine;
+		std::pmr::vector<int> Free;
+		int Root;
+		bool Building;
+		unsigned int Seed;
+
+		unsigned int Random();
+		unsigned int Size(int t) const { return (t < 0) ? 0 : this->Nodes[t].size; }
+		unsigned int Resize(int t);
+		int NewNode(const lineview &line);
+		void Split(int t, unsigned int pos, int &a, int &b);
+		int Merge(int a, int b);
+
+	public:
+		INILineTable(std::pmr::memory_resource *Memory);
+
+		void Clear();
+		void Reserve(std::size_t n);
+		unsigned int Count();
+		int End();
+		int Append(const lineview &line);
+		int Insert(unsigned int pos, const lineview &line);
+		int InsertAfter(int handle, const lineview &line);
+		void Erase(unsigned int pos, unsigned int count);
+		unsigned int Line(int handle);
+		int At(unsigned int pos);
+		int First();
+		int Next(int handle);
+
+		lineview &operator[](int handle) { return this->Nodes[handle].line; }
+};
+
+#endif
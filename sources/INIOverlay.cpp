@@ -0,0 +1,511 @@
+//--------------------------------------------------------------------------
+//                                INIOVERLAY.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INIOverlay.cpp
+//! \brief Functions for merging several INI files
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#include <atomic>
+#include <thread>
+
+#if __linux__
+#include <glob.h>
+#endif
+
+#pragma hdrstop
+
+#include "INIOverlay.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              PUBLIC FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INIOverlay class
+//! \return   an instance of the class
+//!
+//--------------------------------------------------------------------------
+__CALL INIOverlay::INIOverlay()
+{
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Open and merge a list of INI files
+//! \param    Files     the files, from the lowest to the highest precedence
+//! \param    Flags     flags for opening the files (see INIOpenFlags)
+//! \param    Threads   the number of threads parsing the files (0 for one per core)
+//! \return   true if every file has been opened
+//!
+//! Every file is parsed by its own INIParser, the files being shared by
+//! the threads, then the layers are merged in order. A file which cannot
+//! be opened, or whose parsing throws an exception (e.g. std::bad_alloc),
+//! is an empty layer (see IsLoaded()): the other ones are merged anyway,
+//! and false is returned.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIOverlay::Open(const vector<string> &Files, int Flags, unsigned int Threads)
+{
+	size_t n = Files.size();
+
+	this->Layers.clear();
+	for(size_t i = 0; i < n; i++)
+		this->Layers.push_back(unique_ptr<INIParser>(new INIParser()));
+	this->Loaded.assign(n, 0);
+
+	if(Threads == 0)
+		Threads = thread::hardware_concurrency();
+	if(Threads > n)
+		Threads = n;
+	if(Threads == 0)
+		Threads = 1;
+
+	// every thread takes the next file until there is none, the exceptions
+	// must not leave the threads
+	atomic<size_t> Next(0);
+	auto Work = [&]()
+	{
+		for(size_t i = Next++; i < n; i = Next++)
+		{
+			try
+			{
+				this->Loaded[i] = this->Layers[i]->Open(Files[i].c_str(), Flags);
+			}
+			catch(...)
+			{
+				this->Loaded[i] = 0;
+			}
+		}
+	};
+
+	// a thread which cannot be created leaves its files to the other ones
+	vector<thread> Pool;
+	try
+	{
+		Pool.reserve(Threads - 1);
+		for(unsigned int t = 1; t < Threads; t++)
+			Pool.push_back(thread(Work));
+	}
+	catch(...)
+	{
+	}
+	Work();
+	for(size_t t = 0; t < Pool.size(); t++)
+		Pool[t].join();
+
+	// a parser interrupted by an exception may keep a part of its file
+	for(size_t i = 0; i < n; i++)
+	{
+		if(!this->Loaded[i])
+			this->Layers[i].reset(new INIParser());
+	}
+
+	this->Merge();
+
+	for(size_t i = 0; i < n; i++)
+	{
+		if(!this->Loaded[i])
+			return false;
+	}
+	return true;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Open and merge the INI files matching a pattern
+//! \param    Pattern   a pattern of file names (for example "conf.d/*.ini")
+//! \param    Flags     flags for opening the files (see INIOpenFlags)
+//! \param    Threads   the number of threads parsing the files (0 for one per core)
+//! \return   true if at least one file matches and every file has been opened
+//!
+//! The matching files are sorted by name, so "10-base.ini" is overridden by
+//! "20-host.ini". The pattern is only supported on GNU/Linux.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIOverlay::Open(const char *Pattern, int Flags, unsigned int Threads)
+{
+	vector<string> Files;
+
+#if __linux__
+	glob_t g;
+	if(glob(Pattern, 0, NULL, &g) == 0)
+	{
+		for(size_t i = 0; i < g.gl_pathc; i++)
+			Files.push_back(g.gl_pathv[i]);
+	}
+	globfree(&g);
+#endif
+
+	bool success = this->Open(Files, Flags, Threads);
+	return success && !Files.empty();
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the number of layers
+//! \return   the number of files given to Open()
+//!
+//--------------------------------------------------------------------------
+int __CALL INIOverlay::GetLayerNumber()
+{
+	return this->Layers.size();
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the parser of a layer
+//! \param    layer    the index of the layer (its rank in the list of files)
+//! \return   the parser of the file of the layer
+//!
+//! The parser is read-only (see INIParser::Find() and
+//! INIParser::GetSections()), the merged index refers to it.
+//!
+//--------------------------------------------------------------------------
+const INIParser * __CALL INIOverlay::GetLayer(int layer)
+{
+	return this->Layers[layer].get();
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Check that the file of a layer has been opened
+//! \param    layer    the index of the layer
+//! \return   true if the file has been opened
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIOverlay::IsLoaded(int layer)
+{
+	return this->Loaded[layer] != 0;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the sections name of the merged files
+//! \return   a vector of strings with the sections name
+//!
+//--------------------------------------------------------------------------
+vector<string> __CALL INIOverlay::GetSectionsName()
+{
+	vector<string> Keys;
+	Keys.reserve(this->Sections.size());
+	for(unsigned int i = 0; i < this->Sections.size(); i++)
+		Keys.push_back(string(this->SectionView(i).key));
+
+	return Keys;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the sections number of the merged files
+//! \return   an integer representing the sections number
+//!
+//--------------------------------------------------------------------------
+int __CALL INIOverlay::GetSectionNumber()
+{
+	return this->Sections.size();
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a specified section of the merged files
+//! \param    SectionName  a char pointer for the section name to get
+//! \return   a section structure
+//!
+//! The comment and the line of the section come from its last declaration,
+//! and the line of a parameter is its line in the file of its layer. If the
+//! specified section cannot be foud, this function returns an empty section.
+//!
+//--------------------------------------------------------------------------
+section __CALL INIOverlay::GetSection(const char *SectionName)
+{
+	section sd;
+	int k = this->IndexFind(INIHashSection(SectionName), SectionName, "", true);
+
+	if(k < 0)
+	{
+		sd.key = "";
+		return sd;
+	}
+
+	const overlaysection &s = this->Sections[this->Index[k].sec];
+	const sectionview &sv = this->SectionView(this->Index[k].sec);
+	sd.key = string(sv.key);
+	sd.comment = string(sv.comment);
+	sd.line = this->Layers[s.layer]->GetLineNumber(sv.handle);
+	for(int j = s.first; j >= 0; j = this->Params[j].next)
+	{
+		const parameterview &p = this->ParamView(j);
+		parameter pd;
+		pd.name = string(p.name);
+		pd.value = string(p.value);
+		pd.comment = string(p.comment);
+		pd.line = this->Layers[this->Params[j].layer]->GetLineNumber(p.handle);
+		sd.parameters.push_back(pd);
+	}
+
+	return sd;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a parameter in the merged files
+//! \param    section    the section name
+//! \param    key        the parameter name
+//! \return   a pointer to the parameter structure (NULL if it cannot be found)
+//!
+//! The parameter gives its layer and its index in the parser of the layer.
+//!
+//--------------------------------------------------------------------------
+const overlayparam * __CALL INIOverlay::Find(string_view section, string_view key)
+{
+	int k = this->IndexFind(INIHashKey(section, key), section, key, false);
+
+	if(k < 0)
+		return NULL;
+
+	return &(this->Params[this->Index[k].param]);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the file where the value of a key comes from
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    Line       receives the line of the key in this file (optionnal)
+//! \return   the name of the file ("" if the key cannot be found)
+//!
+//--------------------------------------------------------------------------
+string __CALL INIOverlay::GetSource(const char *section, const char *key, int *Line)
+{
+	const overlayparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return "";
+
+	INIParser *Parser = this->Layers[p->layer].get();
+	if(Line != NULL)
+		*Line = Parser->GetLineNumber(Parser->Params[p->param].handle);
+	return Parser->FileName;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a boolean value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a boolean representing the value of the specified key
+//!
+//! See INIParser::GetBoolean().
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIOverlay::GetBoolean(const char *section, const char *key)
+{
+	const overlayparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return false;
+
+	return this->Layers[p->layer]->Convert(p->param, 2)->boolean;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a string value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a string representing the value of the specified key
+//!
+//--------------------------------------------------------------------------
+string __CALL INIOverlay::GetString(const char *section, const char *key)
+{
+	const overlayparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return "";
+
+	return string(this->Layers[p->layer]->Params[p->param].value);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get an integer value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   an integer representing the value of the specified key
+//!
+//! See INIParser::GetInteger().
+//!
+//--------------------------------------------------------------------------
+int __CALL INIOverlay::GetInteger(const char *section, const char *key)
+{
+	const overlayparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return 0;
+
+	return int(this->Layers[p->layer]->Convert(p->param, 0)->integer);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a double value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a double representing the value of the specified key
+//!
+//! See INIParser::GetDouble().
+//!
+//--------------------------------------------------------------------------
+double __CALL INIOverlay::GetDouble(const char *section, const char *key)
+{
+	const overlayparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return 0.0;
+
+	return this->Layers[p->layer]->Convert(p->param, 1)->real;
+}
+
+//--------------------------------------------------------------------------
+//                              PRIVATE FUNCTIONS
+//--------------------------------------------------------------------------
+
+// --------------------------------------------------------------------------
+// The section of the parser of the layer for a merged section
+const sectionview & __CALL INIOverlay::SectionView(int sec)
+{
+	const overlaysection &s = this->Sections[sec];
+	return this->Layers[s.layer]->Sections[s.sec];
+}
+
+// --------------------------------------------------------------------------
+// The parameter of the parser of the layer for a merged parameter
+const parameterview & __CALL INIOverlay::ParamView(int param)
+{
+	const overlayparam &p = this->Params[param];
+	return this->Layers[p.layer]->Params[p.param];
+}
+
+// --------------------------------------------------------------------------
+// Merge the layers in order: a section or a key already merged takes the
+// declaration of the new layer, the other ones are added at the end
+void __CALL INIOverlay::Merge()
+{
+	this->Sections.clear();
+	this->Params.clear();
+
+	// the index is sized once for all the declarations (at most half full)
+	size_t total = 0;
+	for(size_t l = 0; l < this->Layers.size(); l++)
+		total += this->Layers[l]->Sections.size() + this->Layers[l]->Params.size();
+	size_t slots = 32;
+	while(slots < 2 * total)
+		slots *= 2;
+	keyslot empty = {0, -1, -1};
+	this->Index.assign(slots, empty);
+
+	for(size_t l = 0; l < this->Layers.size(); l++)
+	{
+		INIParser &P = *(this->Layers[l]);
+		for(unsigned int s = 0; s < P.Sections.size(); s++)
+		{
+			const sectionview &sv = P.Sections[s];
+			unsigned long long h = INIHashSection(sv.key);
+			int k = this->IndexFind(h, sv.key, "", true);
+			int i;
+			if(k < 0)
+			{
+				i = this->Sections.size();
+				overlaysection os;
+				os.first = -1;
+				os.last = -1;
+				this->Sections.push_back(os);
+				this->IndexInsert(h, i, -1);
+			}
+			else
+			{
+				i = this->Index[k].sec;
+			}
+			this->Sections[i].layer = l;
+			this->Sections[i].sec = s;
+
+			for(int j = sv.first; j >= 0; j = P.Params[j].next)
+			{
+				string_view name = P.Params[j].name;
+				h = INIHashKey(sv.key, name);
+				k = this->IndexFind(h, sv.key, name, false);
+				if(k >= 0)
+				{
+					overlayparam &op = this->Params[this->Index[k].param];
+					op.layer = l;
+					op.param = j;
+					continue;
+				}
+
+				int m = this->Params.size();
+				overlayparam op;
+				op.layer = l;
+				op.param = j;
+				op.next = -1;
+				this->Params.push_back(op);
+				overlaysection &os = this->Sections[i];
+				if(os.last >= 0)
+					this->Params[os.last].next = m;
+				else
+					os.first = m;
+				os.last = m;
+				this->IndexInsert(h, i, m);
+			}
+		}
+	}
+}
+
+// --------------------------------------------------------------------------
+// Add an entry to the merged index (the entry is new and the index is sized
+// by Merge())
+void __CALL INIOverlay::IndexInsert(unsigned long long hash, int sec, int param)
+{
+	size_t mask = this->Index.size() - 1;
+	size_t k = hash & mask;
+	while(this->Index[k].sec >= 0)
+		k = (k + 1) & mask;
+
+	this->Index[k].hash = hash;
+	this->Index[k].sec = sec;
+	this->Index[k].param = param;
+}
+
+// --------------------------------------------------------------------------
+// Look for an entry in the merged index (see INIParser::IndexFind())
+int __CALL INIOverlay::IndexFind(unsigned long long hash, string_view section, string_view key, bool IsSection)
+{
+	if(this->Index.size() == 0)
+		return -1;
+
+	size_t mask = this->Index.size() - 1;
+	for(size_t k = hash & mask; ; k = (k + 1) & mask)
+	{
+		const keyslot &e = this->Index[k];
+		if(e.sec < 0)
+			return -1;
+		if(e.hash != hash || (e.param < 0) != IsSection)
+			continue;
+
+		if(INISameName(this->SectionView(e.sec).key, section) && (IsSection || INISameName(this->ParamView(e.param).name, key)))
+			return k;
+	}
+}
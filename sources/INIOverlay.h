@@ -0,0 +1,110 @@
+//--------------------------------------------------------------------------
+//                                INIOVERLAY.H
+//--------------------------------------------------------------------------
+//!
+//! \file INIOverlay.h
+//! \brief Header file for merging several INI files
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INIOverlayH
+#define INIOverlayH
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+#include "INIParser.h"
+
+//--------------------------------------------------------------------------
+//                              STRUCTURES DECLARATIONS
+//--------------------------------------------------------------------------
+
+//! \brief structure for a section of the merged index
+struct overlaysection
+{
+	//! \brief the layer of the last declaration of the section
+	int layer;
+	//! \brief the index of the section in the parser of this layer
+	int sec;
+	//! \brief the index of the first parameter of the section (-1 if the section is empty)
+	int first;
+	//! \brief the index of the last parameter of the section (-1 if the section is empty)
+	int last;
+};
+
+//! \brief structure for a parameter of the merged index
+struct overlayparam
+{
+	//! \brief the layer of the value (the index of its file)
+	int layer;
+	//! \brief the index of the parameter in the parser of this layer
+	int param;
+	//! \brief the index of the next parameter of the same section (-1 for the last one)
+	int next;
+};
+
+//--------------------------------------------------------------------------
+//                              INIOVERLAY CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INIOverlay
+//! \brief INIOverlay class.
+//!
+//! This class merges an ordered list of INI files (the layers, for example
+//! a base file and its environment, region and host overrides). The files
+//! are parsed at the same time by a pool of threads, each one by its own
+//! INIParser, then their keys are merged into one index: the value of a key
+//! comes from the last layer which declares it, and remembers this layer.
+//! The sections and the parameters keep the order of their first
+//! declaration.
+//!
+//--------------------------------------------------------------------------
+class INIOverlay
+{
+	private:
+		std::vector<std::unique_ptr<INIParser>> Layers;
+		std::vector<char> Loaded;
+		std::vector<overlaysection> Sections;
+		std::vector<overlayparam> Params;
+		std::vector<keyslot> Index;
+
+		const sectionview & __CALL SectionView(int sec);
+		const parameterview & __CALL ParamView(int param);
+		void __CALL Merge();
+		void __CALL IndexInsert(unsigned long long hash, int sec, int param);
+		int __CALL IndexFind(unsigned long long hash, std::string_view section, std::string_view key, bool IsSection);
+
+	public:
+		__CALL INIOverlay();
+		INIOverlay(const INIOverlay &) = delete;
+		INIOverlay &operator=(const INIOverlay &) = delete;
+		bool __CALL Open(const std::vector<std::string> &Files, int Flags=INI_DEFAULT, unsigned int Threads=0);
+		bool __CALL Open(const char *Pattern, int Flags=INI_DEFAULT, unsigned int Threads=0);
+
+		int __CALL GetLayerNumber();
+		const INIParser * __CALL GetLayer(int layer);
+		bool __CALL IsLoaded(int layer);
+
+		std::vector<std::string> __CALL GetSectionsName();
+		int __CALL GetSectionNumber();
+		section __CALL GetSection(const char *SectionName);
+		const overlayparam * __CALL Find(std::string_view section, std::string_view key);
+		std::string __CALL GetSource(const char *section, const char *key, int *Line=NULL);
+		bool __CALL GetBoolean(const char *section, const char *key);
+		std::string __CALL GetString(const char *section, const char *key);
+		int __CALL GetInteger(const char *section, const char *key);
+		double __CALL GetDouble(const char *section, const char *key);
+};
+
+#endif
@@ -17,10 +17,36 @@
 //#include <stdio>
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cerrno>
+#include <ctype.h>
+#include <thread>
+#include <functional>
+
+#ifdef INI_STATS
+#include <chrono>
+#endif
+
+#if __linux__
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/inotify.h>
+#include <sys/uio.h>
+#include <limits.h>
+#endif
 
 #pragma hdrstop
 
 #include "INIParser.h"
+#include "INISnapshot.h"
+#include "INIAsync.h"
+#include "INIInternPool.h"
 
 #pragma package(smart_init)
 //--------------------------------------------------------------------------
@@ -28,13 +54,446 @@
 using namespace std;
 
 //--------------------------------------------------------------------------
-//                              INIPARSER METHODS
+//                              LOCAL CLASSES
 //--------------------------------------------------------------------------
 
+namespace
+{
+
+#if __linux__
+//--------------------------------------------------------------------------
+// Stream buffer writing into a file descriptor by blocks of 64 KB
+class INIFileBuffer : public streambuf
+{
+	private:
+		int fd;
+		char buffer[65536];
+
+		bool Flush()
+		{
+			const char *p = this->pbase();
+			size_t n = this->pptr() - p;
+			while(n > 0)
+			{
+				ssize_t w = write(this->fd, p, n);
+				if(w < 0 && errno == EINTR)
+					continue;
+				if(w <= 0)
+					return false;
+				p += w;
+				n -= w;
+				this->count += w;
+			}
+			this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+			return true;
+		}
+
+	protected:
+		int_type overflow(int_type c) override
+		{
+			if(!this->Flush())
+				return traits_type::eof();
+			if(!traits_type::eq_int_type(c, traits_type::eof()))
+			{
+				*(this->pptr()) = traits_type::to_char_type(c);
+				this->pbump(1);
+			}
+			return traits_type::not_eof(c);
+		}
+
+		int sync() override
+		{
+			return this->Flush() ? 0 : -1;
+		}
+
+	public:
+		size_t count;
+
+		INIFileBuffer(int fd)
+		{
+			this->fd = fd;
+			this->count = 0;
+			this->setp(this->buffer, this->buffer + sizeof(this->buffer));
+		}
+};
+#endif
+
+//--------------------------------------------------------------------------
+// Stream buffer writing into a caller buffer, and counting all the
+// characters, even the ones which do not fit into the buffer
+class INIArrayBuffer : public streambuf
+{
+	private:
+		char *buffer;
+		size_t size;
+
+	protected:
+		streamsize xsputn(const char *s, streamsize n) override
+		{
+			if(n > 0 && this->count < this->size)
+				memcpy(this->buffer + this->count, s, min((size_t)n, this->size - this->count));
+			this->count += n;
+			return n;
+		}
+
+		int_type overflow(int_type c) override
+		{
+			if(!traits_type::eq_int_type(c, traits_type::eof()))
+			{
+				char ch = traits_type::to_char_type(c);
+				this->xsputn(&ch, 1);
+			}
+			return traits_type::not_eof(c);
+		}
+
+	public:
+		size_t count;
+
+		INIArrayBuffer(char *buffer, size_t size)
+		{
+			this->buffer = buffer;
+			this->size = size;
+			this->count = 0;
+		}
+};
+
+//--------------------------------------------------------------------------
+// Length of the common beginning of two texts (compared by blocks)
+size_t CommonPrefix(string_view a, string_view b)
+{
+	size_t n = min(a.size(), b.size());
+	size_t i = 0;
+	while(i + 4096 <= n && memcmp(a.data() + i, b.data() + i, 4096) == 0)
+		i += 4096;
+	while(i < n && a[i] == b[i])
+		i++;
+	return i;
+}
+
+//--------------------------------------------------------------------------
+// Length of the common end of two texts, at most 'max' characters
+size_t CommonSuffix(string_view a, string_view b, size_t max)
+{
+	const char *x = a.data() + a.size();
+	const char *y = b.data() + b.size();
+	size_t i = 0;
+	while(i + 4096 <= max && memcmp(x - i - 4096, y - i - 4096, 4096) == 0)
+		i += 4096;
+	while(i < max && x[-1 - (ptrdiff_t)i] == y[-1 - (ptrdiff_t)i])
+		i++;
+	return i;
+}
+
+//--------------------------------------------------------------------------
+// Move a view of the old text into the new text. The characters before
+// 'begin' are at the same place, those from 'end' are moved by 'delta' and
+// the views between them are cleared.
+void Rebase(string_view &v, const char *Old, size_t OldSize, const char *New, size_t begin, size_t end, ptrdiff_t delta)
+{
+	uintptr_t d = (uintptr_t)v.data();
+	if(v.data() == NULL || d < (uintptr_t)Old || d > (uintptr_t)Old + OldSize)
+		return;
+
+	size_t offset = d - (uintptr_t)Old;
+	if(offset < begin)
+		v = string_view(New + offset, v.size());
+	else if(offset >= end)
+		v = string_view(New + offset + delta, v.size());
+	else
+		v = string_view();
+}
+
+
+//--------------------------------------------------------------------------
+// Lines of a part of the text parsed by a thread (see ParallelParse()).
+// The indexes of the sections and of the parameters are local to the part.
+struct parsechunk
+{
+	size_t begin;
+	size_t end;
+	size_t breaks;
+	vector<sectionview> sections;
+	vector<parameterview> params;
+	vector<lineview> lines;
+	vector<unsigned long long> hashes;
+	// the positions of the first section, parameter, line and index entry
+	// of the part in the whole file
+	size_t sec;
+	size_t param;
+	size_t line;
+	size_t entry;
+};
+
+//--------------------------------------------------------------------------
+// Run the tasks 0 to n - 1 on 'Threads' threads (the calling one included),
+// every thread takes the next task until there is none
+void RunTasks(size_t n, unsigned int Threads, const function<void(size_t)> &Task)
+{
+	atomic<size_t> Next(0);
+	auto Work = [&]()
+	{
+		for(size_t i = Next++; i < n; i = Next++)
+			Task(i);
+	};
+
+	vector<thread> Pool;
+	for(unsigned int t = 1; t < Threads && t < n; t++)
+		Pool.push_back(thread(Work));
+	Work();
+	for(size_t t = 0; t < Pool.size(); t++)
+		Pool[t].join();
+}
+
+//--------------------------------------------------------------------------
+// Term of an entry of the key index in the layout checksum (splitmix64)
+unsigned long long LayoutTerm(const keyslot &e)
+{
+	unsigned long long x = e.hash + (unsigned long long)(e.sec + 1) * 0x9E3779B97F4A7C15ULL
+		+ (unsigned long long)(e.param + 1) * 0xC2B2AE3D27D4EB4FULL;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
+
+//--------------------------------------------------------------------------
+// Beginning of a number for from_chars(), which does not accept a '+' sign
+const char *NumberBegin(string_view v)
+{
+	const char *b = v.data();
+	if(v.size() > 1 && b[0] == '+' && b[1] != '-' && b[1] != '+')
+		b++;
+	return b;
+}
+
+#if __linux__
+//--------------------------------------------------------------------------
+// Version of a file described by stat()
+void MakeVersion(const struct stat &st, fileversion &v)
+{
+	v.device = st.st_dev;
+	v.inode = st.st_ino;
+	v.size = st.st_size;
+	v.time = (long long)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+}
+
+//--------------------------------------------------------------------------
+// Version of a file, by its name or by an opened file
+bool FileVersion(const char *File, fileversion &v)
+{
+	struct stat st;
+	if(stat(File, &st) != 0)
+		return false;
+	MakeVersion(st, v);
+	return true;
+}
+
+bool FileVersion(int fd, fileversion &v)
+{
+	struct stat st;
+	if(fstat(fd, &st) != 0)
+		return false;
+	MakeVersion(st, v);
+	return true;
+}
+
+//--------------------------------------------------------------------------
+// Compare two versions of a file
+bool SameVersion(const fileversion &a, const fileversion &b)
+{
+	return a.device == b.device && a.inode == b.inode && a.size == b.size && a.time == b.time;
+}
+
+//--------------------------------------------------------------------------
+// Write a list of buffers, completing the partial writes of writev()
+bool WriteAll(int fd, vector<iovec> &v)
+{
+	size_t i = 0;
+	while(i < v.size())
+	{
+		ssize_t n = writev(fd, &v[i], min(v.size() - i, (size_t)IOV_MAX));
+		if(n < 0)
+		{
+			if(errno == EINTR)
+				continue;
+			return false;
+		}
+		while(i < v.size() && (size_t)n >= v[i].iov_len)
+			n -= v[i++].iov_len;
+		if(n > 0)
+		{
+			v[i].iov_base = (char *)v[i].iov_base + n;
+			v[i].iov_len -= n;
+		}
+	}
+	return true;
+}
+
+//--------------------------------------------------------------------------
+// File replaced by a write: the target of a symbolic link, so the link is
+// kept (the name itself if it cannot be resolved, e.g. a new file)
+string WriteTarget(const char *File)
+{
+	char *Real = realpath(File, NULL);
+	if(Real == NULL)
+		return File;
+
+	string Target(Real);
+	free(Real);
+	return Target;
+}
+#endif
+
+#ifdef INI_STATS
+//--------------------------------------------------------------------------
+// Add the time of its scope to a phase of the statistics
+class INIStatsTimer
+{
+	private:
+		INIStats &Stats;
+		int Phase;
+		chrono::steady_clock::time_point Start;
+
+	public:
+		INIStatsTimer(INIStats &Stats, int Phase) : Stats(Stats), Phase(Phase)
+		{
+			this->Start = chrono::steady_clock::now();
+		}
+
+		~INIStatsTimer()
+		{
+			chrono::steady_clock::duration d = chrono::steady_clock::now() - this->Start;
+			this->Stats.calls[this->Phase]++;
+			this->Stats.time[this->Phase] += chrono::duration_cast<chrono::nanoseconds>(d).count();
+		}
+};
+
+//--------------------------------------------------------------------------
+// Write the HELP and TYPE lines of a metric
+void MetricHeader(ostream &Out, const char *name, const char *type, const char *help)
+{
+	Out << "# HELP " << name << ' ' << help << '\n';
+	Out << "# TYPE " << name << ' ' << type << '\n';
+}
+#endif
+
+}
+
+//--------------------------------------------------------------------------
+// Statistics of the parser (nothing is counted without INI_STATS)
+#ifdef INI_STATS
+#define INI_COUNT(counter, n) (this->Stats.counter += (n))
+#define INI_TIME(phase) INIStatsTimer StatsTimer(this->Stats, phase)
+#else
+#define INI_COUNT(counter, n) ((void)0)
+#define INI_TIME(phase) ((void)0)
+#endif
+
+//--------------------------------------------------------------------------
+//                              CONVERSION FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Convert a value into an integer
+//! \param    value    the value to convert
+//! \param    result   the converted value
+//! \return   INI_VALUE_OK, or INI_VALUE_MALFORMED if the value is not an integer
+//!
+//! The value is converted with std::from_chars(). A malformed value gives the
+//! truncated number found at its beginning, as GetInteger() always did (2 for
+//! "2.5", 0 for "abc").
+//!
+//--------------------------------------------------------------------------
+INIValueStatus INIToInteger(string_view value, long long &result)
+{
+	const char *e = value.data() + value.size();
+	long long i;
+	from_chars_result r = from_chars(NumberBegin(value), e, i);
+	if(r.ec == errc() && r.ptr == e)
+	{
+		result = i;
+		return INI_VALUE_OK;
+	}
+
+	double d;
+	INIToDouble(value, d);
+	if(d != d)
+		result = 0;
+	else if(d >= 9223372036854775807.0)
+		result = LLONG_MAX;
+	else if(d <= -9223372036854775808.0)
+		result = LLONG_MIN;
+	else
+		result = (long long)d;
+	return INI_VALUE_MALFORMED;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Convert a value into a double
+//! \param    value    the value to convert
+//! \param    result   the converted value
+//! \return   INI_VALUE_OK, or INI_VALUE_MALFORMED if the value is not a number
+//!
+//! The value is converted with std::from_chars(). A malformed value gives the
+//! number found at its beginning (0.0 if there is none).
+//!
+//--------------------------------------------------------------------------
+INIValueStatus INIToDouble(string_view value, double &result)
+{
+	const char *e = value.data() + value.size();
+	double d;
+	from_chars_result r = from_chars(NumberBegin(value), e, d);
+	if(r.ec != errc())
+	{
+		result = 0.0;
+		return INI_VALUE_MALFORMED;
+	}
+
+	result = d;
+	return (r.ptr == e) ? INI_VALUE_OK : INI_VALUE_MALFORMED;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Convert a value into a boolean
+//! \param    value    the value to convert
+//! \param    result   the converted value
+//! \return   INI_VALUE_OK, or INI_VALUE_MALFORMED if the value is not a boolean
+//!
+//! "true" and "1" are true, "false" and "0" are false (in any case). Any
+//! other value is malformed and gives false.
+//!
+//--------------------------------------------------------------------------
+INIValueStatus INIToBoolean(string_view value, bool &result)
+{
+	static const char *Names[4] = { "false", "true", "0", "1" };
+
+	for(int i = 0; i < 4; i++)
+	{
+		size_t n = strlen(Names[i]);
+		if(value.size() != n)
+			continue;
+
+		size_t c = 0;
+		while(c < n && tolower((unsigned char)value[c]) == Names[i][c])
+			c++;
+		if(c == n)
+		{
+			result = (i % 2) == 1;
+			return INI_VALUE_OK;
+		}
+	}
+
+	result = false;
+	return INI_VALUE_MALFORMED;
+}
+
 //-------------------------------------------------------------------------
 //!
 //! \brief    Constructor of the INIParser class
 //! \param    File   INI File to open (optionnal)
+//! \param    Flags  flags for opening the file (see INIOpenFlags)
 //! \return   an instance of the class
 //! 
 //! This function creates an instance of the INIParser class
@@ -42,20 +501,43 @@ using namespace std;
 //! 
 //!
 //--------------------------------------------------------------------------
-__CALL INIParser::INIParser(const char* File)
+__CALL INIParser::INIParser(const char* File, int Flags) :
+	Sections(&Memory), Params(&Memory), Lines(&Memory), Index(&Memory), Strings(&Memory),
+	KeyOrder(&Memory), NameOrder(&Memory)
 {
-	this->dico = new dictionnary;
-	this->Keys = new vector<string>;
-	this->KeysLines = new vector<unsigned int>;
-	this->Comments = new vector<comment>;
-	this->LinesType = new std::vector<int>;
+	this->IndexCount = 0;
+	this->Layout = 0;
+	this->OrderLayout = 0;
+	this->OrderBuilt = false;
+	this->Mapping = NULL;
+	this->MappingSize = 0;
+	this->DicoChanged = true;
+	this->FileName = NULL;
+	this->UpdateCount = 0;
+	this->Modified = false;
+	this->AutoPublish = false;
+	this->Version.store(0);
+	for(int i = 0; i < 2; i++)
+	{
+		this->Published[i].version.store(0);
+		this->Published[i].readers.store(0);
+	}
+	this->OpenFlags = INI_DEFAULT;
+	this->Pristine = false;
+	this->Duplicates = false;
+	this->Interned = false;
+	this->TextSize = 0;
+	this->TextHash = 0;
+	this->WatchHandle = -1;
+	this->Cancelled = NULL;
+	this->Patchable = false;
+#ifdef INI_STATS
+	this->ResetStats();
+#endif
 
-	this->FileEndLine = 0;
-	this->EndLine = 0;
-	
 	if(File != NULL)
 	{
-		this->Open(File);
+		this->Open(File, Flags);
 	}
 }
 
@@ -69,11 +551,15 @@ __CALL INIParser::INIParser(const char* File)
 //--------------------------------------------------------------------------
 __CALL INIParser::~INIParser()
 {
-	delete this->dico;
-	delete this->Keys;
-	delete this->KeysLines;
-	delete this->Comments;
-	delete this->LinesType;
+	// an opening in the background must be over before the parser goes
+	if(this->Pending && !this->Pending->Abandon())
+		this->Pending->Wait();
+	this->Unwatch();
+	this->Unmap();
+
+	// the names are given back to the pool of the process
+	if(this->Interned)
+		this->Release(INI_DEFAULT);
 }
 
 
@@ -81,865 +567,3478 @@ __CALL INIParser::~INIParser()
 //!
 //! \brief    Open an INI File
 //! \param    File   INI File to open
+//! \param    Flags  flags for opening the file (see INIOpenFlags)
 //! \return   a boolean. true if file is opened, false otherwise
 //! 
 //! This function opens an ini file and reads it
+//! With the INI_MAPPED flag, the file is mapped read-only in memory and the
+//! names, values and comments of the index are views into the mapping, so
+//! the text of the file is not copied (INIParser::TextFile stays empty).
+//! The mapped file must not be truncated while it is opened.
+//! With the INI_ARENA flag, the text (if it is not mapped), the index and the
+//! stored values are allocated in a few contiguous blocks, which are released
+//! at once by the next INIParser::Open() or by the destructor (INIParser::TextFile
+//! stays empty too).
+//! With the INI_INTERN flag, the names are kept in the pool of the process
+//! and the text of the file is freed once it is parsed (see Compact()), so
+//! INIParser::TextFile stays empty. The INI_ARENA flag is then ignored.
+//! With the INI_SNAPSHOT flag, a snapshot of the file is published once it
+//! is parsed (see INIParser::Publish()). If the file cannot be opened, the
+//! readers keep the previous snapshot.
+//! 
+//! This function returns true in case of success.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::Open(const char* File, int Flags)
+{
+	// the arena would keep the text freed by Compact()
+	if(Flags & INI_INTERN)
+		Flags &= ~INI_ARENA;
+
+	this->Release(Flags);
+	this->IndexCount = 0;
+	this->Layout = 0;
+	this->dico.sections.clear();
+	this->dico.Keys.clear();
+	this->DicoChanged = true;
+	this->Source = string_view();
+	this->Unmap();
+	this->TextFile = "";
+	this->UpdateCount = 0;
+	this->Modified = false;
+	this->AutoPublish = (Flags & INI_SNAPSHOT) != 0;
+	this->OpenFlags = Flags;
+	this->Pristine = false;
+	this->Duplicates = false;
+	this->Patches.clear();
+	this->Patchable = false;
+
+	// the watch is kept when the same file is reopened
+	if(this->WatchHandle >= 0 && this->Path != File)
+		this->Unwatch();
+	this->Path = File;
+	this->FileName = this->Path.c_str();
+
+	// the version of the file is taken before reading it (see Track())
+	fileversion Before = fileversion();
+	bool Known = false;
+#if __linux__
+	Known = FileVersion(this->FileName, Before);
+#endif
+	if(!this->Load(this->FileName, Flags))
+		return false;
+	INI_COUNT(bytesread, this->Source.size());
+
+	// an opening cancelled while the file was read is not parsed (see OpenAsync())
+	if(this->Cancelled != NULL && this->Cancelled->load())
+	{
+		this->Source = string_view();
+		this->Unmap();
+		this->TextFile = "";
+		this->Release(Flags);
+		return false;
+	}
+
+	if(Flags & INI_PARALLEL)
+		this->ParallelParse();
+	else
+		this->Parse();
+	if(Flags & INI_INTERN)
+		this->Compact();
+	this->Track(Known, Before);
+	if(this->AutoPublish)
+		this->Publish();
+
+	return true;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Open an INI File in the background
+//! \param    File      INI File to open
+//! \param    Flags     flags for opening the file (see INIOpenFlags)
+//! \param    Executor  the executor running the opening (a new thread if empty)
+//! \return   the task of the opening (see INIOpenTask)
+//!
+//! The file is read and parsed by Open(), called by the executor, so the
+//! calling thread never blocks. The executor is given a function to run
+//! once, by any thread (e.g. the thread pool of the program); if it drops
+//! the function without running it, the task is cancelled. Until the task
+//! is done, the parser must not be used. Destroying the parser, or opening
+//! another file in the background, cancels the task: if the executor has
+//! not started it yet, the task is done at once (the executor may be run
+//! later by the same thread), otherwise the parser waits for it.
+//! If the task is cancelled before the file is parsed, the parser is left
+//! as it was if the executor has not started the task, and without file
+//! otherwise. If the file cannot be opened (or Open() throws an
+//! exception), the status of the task is INI_OPEN_FAILED and
+//! INIOpenTask::GetError() gives the errno value.
+//!
+//--------------------------------------------------------------------------
+INIOpenTask __CALL INIParser::OpenAsync(const char* File, int Flags, INIExecutor Executor)
+{
+	if(this->Pending && !this->Pending->Abandon())
+		this->Pending->Wait();
+
+	INIOpenTask Task;
+	shared_ptr<INIOpenTask::state> S = Task.State;
+	string Path(File);
+
+	// the task is cancelled when the last copy of the function is destroyed
+	// without being run (a no-op once the task is done)
+	shared_ptr<void> Dropped(nullptr, [S](void *)
+	{
+		INIOpenTask::Finish(*S, INI_OPEN_CANCELLED, 0);
+	});
+
+	// the parser is not used by a task cancelled before it is started, it
+	// may be destroyed already
+	function<void()> Job = [this, S, Dropped, Path, Flags]()
+	{
+		if(!INIOpenTask::Start(*S))
+		{
+			INIOpenTask::Finish(*S, INI_OPEN_CANCELLED, 0);
+			return;
+		}
+
+		// the exceptions must not leave the thread of the executor
+		bool Success = false;
+		int Error = 0;
+		this->Cancelled = &(S->Cancelled);
+		try
+		{
+			errno = 0;
+			Success = this->Open(Path.c_str(), Flags);
+			Error = errno;
+		}
+		catch(const bad_alloc &)
+		{
+			Error = ENOMEM;
+		}
+		catch(...)
+		{
+			Error = EIO;
+		}
+		this->Cancelled = NULL;
+
+		if(Success)
+			INIOpenTask::Finish(*S, INI_OPEN_DONE, 0);
+		else if(S->Cancelled.load())
+			INIOpenTask::Finish(*S, INI_OPEN_CANCELLED, 0);
+		else
+			INIOpenTask::Finish(*S, INI_OPEN_FAILED, Error != 0 ? Error : EIO);
+	};
+	Dropped.reset();
+
+	this->Pending = make_shared<INIOpenTask>(Task);
+	try
+	{
+		if(Executor)
+			Executor(Job);
+		else
+			thread(Job).detach();
+	}
+	catch(...)
+	{
+		INIOpenTask::Finish(*S, INI_OPEN_FAILED, EAGAIN);
+	}
+
+	return Task;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Load the text of an INI File
+//! \param    File   INI File to load
+//! \param    Flags  flags for opening the file (see INIOpenFlags)
+//! \return   a boolean. true if file is loaded, false otherwise
+//! 
+//! This function is for local using only. The file is either read at once
+//! into INIParser::TextFile or mapped in memory (INI_MAPPED flag, only
+//! available on GNU/Linux). Then INIParser::Source refers to the text.
 //! 
 //! This function returns true in case of success.
 //!
 //--------------------------------------------------------------------------
-bool __CALL INIParser::Open(const char* File)
+bool __CALL INIParser::Load(const char *File, int Flags)
 {
-	this->KeysLines->clear();
-	this->dico->sections.clear();
-	this->dico->Keys.clear();
-	this->Keys->clear();
+	INI_TIME(INI_PHASE_LOAD);
+
+#if __linux__
+	if(Flags & INI_MAPPED)
+	{
+		int fd = open(File, O_RDONLY);
+		if(fd < 0)
+			return false;
+
+		struct stat st;
+		if(fstat(fd, &st) != 0)
+		{
+			close(fd);
+			return false;
+		}
+
+		// an empty file cannot be mapped, and there is nothing to parse
+		if(st.st_size > 0)
+		{
+			void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if(m == MAP_FAILED)
+			{
+				close(fd);
+				return false;
+			}
+			this->Mapping = m;
+			this->MappingSize = st.st_size;
+			this->Source = string_view((const char *)m, st.st_size);
+		}
+		close(fd);
+
+		return true;
+	}
+#endif
+
+	if(!(Flags & INI_ARENA))
+	{
+		if(!this->ReadText(File, this->TextFile))
+			return false;
+		this->Source = this->TextFile;
+		return true;
+	}
 
-	this->FileName = File;
 	ifstream f;
-	f.open(this->FileName, ios::in);
+	f.open(File, ios::in | ios::binary);
 
 	if(!f.is_open())
 		return false;
 
-	string line = "";
-	while (!f.eof())
+	f.seekg(0, ios::end);
+	streamoff size = f.tellg();
+	f.seekg(0, ios::beg);
+	if(size >= 0)
 	{
-		char c = f.get();
-		if((int)(c) == -1)
-			c = '\0';
-		line += (char)c;
-		if(c == '\n')
-		{
-			this->TextFile += line;
-			line = "";
-		}
+		char *text = (char *)this->Memory.allocate(size, 1);
+		f.read(text, size);
+		this->Source = string_view(text, f.gcount());
+	}
+	else
+	{
+		// not a regular file, the size is unknown
+		f.clear();
+		ostringstream ss;
+		ss << f.rdbuf();
+		this->Source = this->StrStore(ss.str());
 	}
 	f.close();
 
 	return true;
 }
 
+//-------------------------------------------------------------------------
+//!
+//! \brief    Read the text of a file
+//! \param    File   the file to read
+//! \param    Text   receives the text of the file
+//! \return   a boolean. true if file is read, false otherwise
+//! 
+//! This function is for local using only. A regular file is read at once.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::ReadText(const char *File, string &Text)
+{
+	ifstream f;
+	f.open(File, ios::in | ios::binary);
+
+	if(!f.is_open())
+		return false;
+
+	f.seekg(0, ios::end);
+	streamoff size = f.tellg();
+	f.seekg(0, ios::beg);
+	if(size >= 0)
+	{
+		Text.resize(size);
+		f.read(&(Text[0]), size);
+		Text.resize(f.gcount());
+	}
+	else
+	{
+		// not a regular file, the size is unknown
+		f.clear();
+		ostringstream ss;
+		ss << f.rdbuf();
+		Text = ss.str();
+	}
+	f.close();
+
+	return true;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Unmap the INI File
+//! 
+//! This function is for local using only. It releases the mapping of the
+//! file opened with the INI_MAPPED flag, if any.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Unmap()
+{
+#if __linux__
+	if(this->Mapping != NULL)
+		munmap(this->Mapping, this->MappingSize);
+#endif
+	this->Mapping = NULL;
+	this->MappingSize = 0;
+}
+
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Release the index of the INI File
+//! \param    Flags  flags for opening the next file (see INIOpenFlags)
+//! 
+//! This function is for local using only. The interned names are released,
+//! the containers of the index give back their memory, then the arena is released at once, and the memory
+//! resource is switched to the arena or to the heap for the next file.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Release(int Flags)
+{
+	// the names of the index are given back to the pool (see Compact())
+	if(this->Interned)
+	{
+		INIInternPool &Pool = INIInternPool::Global();
+		for(size_t i = 0; i < this->Sections.size(); i++)
+			Pool.Release(this->Sections[i].key);
+		for(size_t j = 0; j < this->Params.size(); j++)
+			Pool.Release(this->Params[j].name);
+		this->Interned = false;
+	}
+
+	pmr::vector<sectionview>(&this->Memory).swap(this->Sections);
+	pmr::vector<parameterview>(&this->Memory).swap(this->Params);
+	this->Lines.Clear();
+	pmr::vector<keyslot>(&this->Memory).swap(this->Index);
+	this->Strings.clear();
+	pmr::vector<keyentry>(&this->Memory).swap(this->KeyOrder);
+	pmr::vector<keyentry>(&this->Memory).swap(this->NameOrder);
+	this->OrderBuilt = false;
+
+	this->Memory.Arena.release();
+	this->Memory.UseArena = (Flags & INI_ARENA) != 0;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Trim spaces in a string at start, end or both
+//! \param    strinit string to trim
+//! \param    mode    integer describing what part to trim (optionnal)
+//! \return   a view of the trimmed string
+//! 
+//! This function trims spaces and tabulations which are at start and at end of a string
+//! mode is an integer which could be :
+//!    0 : trims the start of the string
+//!    1 : trims the end of the string
+//!   -1 : trims the start and the end of the string (default)
+//! 
+//! This function returns the trimmed string.
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INIParser::StrTrim(string_view strinit, int mode)
+{
+	// a blank string is trimmed to an empty string
+	if(mode != 1)
+		strinit.remove_prefix(min(strinit.find_first_not_of(" \t"), strinit.size()));
+	if(mode != 0)
+		strinit = strinit.substr(0, strinit.find_last_not_of(" \t") + 1);
+
+	return strinit;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Store a string in the parser
+//! \param    value string to store
+//! \return   a view of the stored string
+//! 
+//! This function is for local using only. It keeps a copy of the names and
+//! values which are not in the text of the INI file (i.e. the ones given to
+//! SetValue()). The copy is allocated like the index (so in the arena with
+//! the INI_ARENA flag) and lives until the next INIParser::Open().
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INIParser::StrStore(string_view value)
+{
+	this->Strings.emplace_front(value);
+
+	return this->Strings.front();
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Store a name in the parser
+//! \param    name the name of a section or of a parameter
+//! \return   a view of the stored name
+//! 
+//! This function is for local using only. A name given to SetValue() is
+//! interned like the other names of the index when they are in the pool
+//! of the process (see Compact()), otherwise it is stored by StrStore().
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INIParser::StrName(string_view name)
+{
+	if(this->Interned)
+		return INIInternPool::Global().Acquire(name);
+
+	return this->StrStore(name);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief   Convert an integer in a string
+//! \param   value integer to convert
+//! \return  a string representing the converted value
+//! 
+//! this function converts an integer to a string.
+//! 
+//! this function returns the converted string.
+//!
+//--------------------------------------------------------------------------
+string __CALL INIParser::NumToStr(int value)
+{
+	if (value == 0)
+		return "0";
+
+	string temp="";
+	string returnvalue="";
+	while (value > 0)
+	{
+		temp += value % 10 + 48;
+		value /= 10;
+	}
+	for(int i = 0; i < temp.length(); i++)
+		returnvalue += temp[temp.length() - i - 1];
+
+	return returnvalue;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief   Convert a double in a string
+//! \param   value double to convert
+//! \param   precision integer representing the decimal number after point (default = 6)
+//! \return  a string representing the converted value
+//! 
+//! this function converts a double to a string with a specified decimal number.
+//! 
+//! this function returns the converted string.
+//!
+//--------------------------------------------------------------------------
+string __CALL INIParser::NumToStr(double value, int precision)
+{
+	if (value == 0.0)
+		return "0.0";
+
+	string temp="";
+	string returnvalue="";
+
+	int IntPart = int(value);
+	while (IntPart > 0)
+	{
+		temp += IntPart % 10 + 48;
+		IntPart /= 10;
+	}
+	for(int i = 0; i < temp.length(); i++)
+		returnvalue += temp[temp.length() - i - 1];
+
+	temp = "";
+	value = double(value) - int(value);
+	value *= pow(10.0, precision);
+	int DecPart = int(value);
+	for(int i = 0; i < precision; i++)
+	{
+		temp += DecPart % 10 + 48;
+		DecPart /= 10;
+	}
+	returnvalue += ".";
+	for(int i = 0; i < temp.length(); i++)
+		returnvalue += temp[temp.length() - i - 1];
+
+	return returnvalue;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Parse the INI File
+//! 
+//! This function is for local using only. The structure of the text is
+//! found in one pass by INIScan(), then the index of sections, parameters
+//! and lines is built from the scanned lines. Names, values and comments
+//! are views into the text. Empty lines are ignored. Types are follow :
+//!    0 : comment line (or text which is not a section nor a parameter)
+//!    1 : key or parameter
+//!    2 : key or parameter with comment
+//! 
+//! All the getters are then served from the index, the text of the
+//! file is never read again.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Parse()
+{
+	INI_TIME(INI_PHASE_PARSE);
+	string_view t = this->Source;
+	int CurrentSection = -1;
+	size_t pos = 0;
+
+	// the number of lines bounds the size of the index, so the containers
+	// are allocated once
+	size_t n = count(t.begin(), t.end(), '\n') + 1;
+	this->Lines.Reserve(n);
+	this->Params.reserve(n);
+	size_t slots = 32;
+	while(slots < 2 * n)
+		slots *= 2;
+	keyslot empty = {0, -1, -1};
+	this->Index.assign(slots, empty);
+
+	scanline sl[256];
+	while(pos < t.size())
+	{
+		size_t nl;
+		pos = INIScan(t, pos, sl, 256, nl);
+
+		for(size_t i = 0; i < nl; i++)
+		{
+			lineview lv;
+			sectionview s;
+			parameterview sp;
+			int kind = this->ParseLine(t, sl[i], CurrentSection >= 0, lv, s, sp);
+
+			if(kind == 1)
+			{
+				s.handle = this->Lines.Count();
+				this->Sections.push_back(s);
+				CurrentSection = this->Sections.size() - 1;
+				this->IndexInsert(CurrentSection, -1);
+				lv.sec = CurrentSection;
+			}
+			else if(kind == 2)
+			{
+				sp.handle = this->Lines.Count();
+				this->Params.push_back(sp);
+
+				int j = this->Params.size() - 1;
+				sectionview &cs = this->Sections[CurrentSection];
+				if(cs.last >= 0)
+					this->Params[cs.last].next = j;
+				else
+					cs.first = j;
+				cs.last = j;
+				this->IndexInsert(CurrentSection, j);
+				lv.sec = CurrentSection;
+				lv.param = j;
+			}
+
+			this->Lines.Append(lv);
+		}
+	}
+
+	INI_COUNT(lines, this->Lines.Count());
+	this->Pristine = true;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Parse the INI File with several threads
+//!
+//! This function is for local using only. The text is cut into parts of
+//! about the same size, each one beginning with a section line: from every
+//! even cut of the text, the lines are read until a section begins. Every
+//! part is scanned by a thread, which parses its lines and hashes their
+//! names, then every part is moved to its place in the index and the key
+//! index is filled by several threads too. So the sections, the parameters,
+//! the line numbers and the comments are the same as the ones of Parse()
+//! (only the slots of the key index may differ). A small file is parsed by
+//! Parse().
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::ParallelParse()
+{
+	const size_t MinChunk = 65536;
+	string_view t = this->Source;
+
+	unsigned int Threads = thread::hardware_concurrency();
+	if(Threads == 0)
+		Threads = 1;
+	size_t n = min((size_t)Threads * 4, t.size() / MinChunk);
+	if(n < 2)
+	{
+		this->Parse();
+		return;
+	}
+
+	INI_TIME(INI_PHASE_PARSE);
+
+	// the parts begin with the first section line after an even cut of the text
+	vector<parsechunk> Chunks(1);
+	Chunks[0].begin = 0;
+	for(size_t c = 1; c < n; c++)
+	{
+		size_t pos = max(c * t.size() / n, Chunks.back().begin + 1);
+		while(pos < t.size())
+		{
+			const char *eol = (const char *)memchr(t.data() + pos - 1, '\n', t.size() - pos + 1);
+			if(eol == NULL)
+			{
+				pos = t.size();
+				break;
+			}
+			pos = eol - t.data() + 1;
+
+			// the first character of the line, which is parsed if it opens a section
+			size_t b = pos;
+			while(b < t.size() && (t[b] == ' ' || t[b] == '\t'))
+				b++;
+			if(b < t.size() && t[b] == '[')
+			{
+				const char *next = (const char *)memchr(t.data() + b, '\n', t.size() - b);
+				size_t e = (next == NULL) ? t.size() : next - t.data() + 1;
+				scanline L;
+				size_t nl;
+				INIScan(t.substr(0, e), pos, &L, 1, nl);
+				lineview lv;
+				sectionview s;
+				parameterview sp;
+				if(nl == 1 && this->ParseLine(t, L, true, lv, s, sp) == 1)
+					break;
+			}
+			pos++;
+		}
+		if(pos >= t.size())
+			break;
+		Chunks.back().end = pos;
+		Chunks.push_back(parsechunk());
+		Chunks.back().begin = pos;
+	}
+	Chunks.back().end = t.size();
+
+	// every part is parsed by a thread
+	RunTasks(Chunks.size(), Threads, [&](size_t c)
+	{
+		parsechunk &P = Chunks[c];
+		string_view part = t.substr(0, P.end);
+		P.breaks = count(t.begin() + P.begin, t.begin() + P.end, '\n');
+		P.lines.reserve(P.breaks + 1);
+
+		int CurrentSection = -1;
+		size_t pos = P.begin;
+		scanline sl[256];
+		while(pos < part.size())
+		{
+			size_t nl;
+			pos = INIScan(part, pos, sl, 256, nl);
+
+			for(size_t i = 0; i < nl; i++)
+			{
+				lineview lv;
+				sectionview s;
+				parameterview sp;
+				int kind = INIParser::ParseLine(t, sl[i], CurrentSection >= 0, lv, s, sp);
+
+				if(kind == 1)
+				{
+					P.sections.push_back(s);
+					CurrentSection = P.sections.size() - 1;
+					P.hashes.push_back(INIHashSection(s.key));
+					lv.sec = CurrentSection;
+				}
+				else if(kind == 2)
+				{
+					P.params.push_back(sp);
+
+					int j = P.params.size() - 1;
+					sectionview &cs = P.sections[CurrentSection];
+					if(cs.last >= 0)
+						P.params[cs.last].next = j;
+					else
+						cs.first = j;
+					cs.last = j;
+					P.hashes.push_back(INIHashKey(cs.key, sp.name));
+					lv.sec = CurrentSection;
+					lv.param = j;
+				}
+
+				P.lines.push_back(lv);
+			}
+		}
+	});
+
+	// the place of every part in the file, the containers are allocated
+	// once, as by Parse()
+	size_t lines = 1, sections = 0, params = 0, entries = 0, nlines = 0;
+	for(size_t c = 0; c < Chunks.size(); c++)
+	{
+		parsechunk &P = Chunks[c];
+		P.sec = sections;
+		P.param = params;
+		P.line = nlines;
+		P.entry = entries;
+		lines += P.breaks;
+		sections += P.sections.size();
+		params += P.params.size();
+		nlines += P.lines.size();
+		entries += P.hashes.size();
+	}
+	this->Lines.Reserve(lines);
+	this->Sections.resize(sections);
+	this->Params.reserve(lines);
+	this->Params.resize(params);
+	size_t slots = 32;
+	while(slots < 2 * lines)
+		slots *= 2;
+	keyslot empty = {0, -1, -1};
+	this->Index.assign(slots, empty);
+
+	// every part is moved to its place, the table of lines is empty, so the
+	// handle of a line will be its position
+	vector<keyslot> Entries(entries);
+	RunTasks(Chunks.size(), Threads, [&](size_t c)
+	{
+		parsechunk &P = Chunks[c];
+		for(size_t i = 0; i < P.sections.size(); i++)
+		{
+			sectionview &s = P.sections[i];
+			if(s.first >= 0)
+			{
+				s.first += P.param;
+				s.last += P.param;
+			}
+			this->Sections[P.sec + i] = s;
+		}
+		for(size_t j = 0; j < P.params.size(); j++)
+		{
+			parameterview &sp = P.params[j];
+			if(sp.next >= 0)
+				sp.next += P.param;
+			this->Params[P.param + j] = sp;
+		}
+
+		size_t h = 0;
+		for(size_t i = 0; i < P.lines.size(); i++)
+		{
+			lineview &lv = P.lines[i];
+			if(lv.sec < 0)
+				continue;
+
+			lv.sec += P.sec;
+			keyslot &e = Entries[P.entry + h];
+			e.hash = P.hashes[h++];
+			e.sec = lv.sec;
+			e.param = -1;
+			if(lv.param >= 0)
+			{
+				lv.param += P.param;
+				e.param = lv.param;
+				this->Params[lv.param].handle = P.line + i;
+			}
+			else
+			{
+				this->Sections[lv.sec].handle = P.line + i;
+			}
+		}
+	});
+
+	// one thread appends the lines, while the others fill the key index:
+	// every thread inserts the entries whose first slot is in its range, in
+	// the order of the file, so the last declaration of a key wins. The
+	// entries which would go past the end of the range are inserted after.
+	size_t R = Threads;
+	size_t mask = slots - 1;
+	vector<vector<size_t>> Deferred(R);
+	vector<unsigned int> Count(R, 0);
+	vector<unsigned long long> Sum(R, 0);
+	vector<char> Dup(R, 0);
+	RunTasks(R + 1, Threads, [&](size_t task)
+	{
+		if(task == 0)
+		{
+			for(size_t c = 0; c < Chunks.size(); c++)
+			{
+				for(size_t i = 0; i < Chunks[c].lines.size(); i++)
+					this->Lines.Append(Chunks[c].lines[i]);
+			}
+			return;
+		}
+
+		size_t r = task - 1;
+		size_t lo = r * slots / R;
+		size_t hi = (r + 1) * slots / R;
+		for(size_t i = 0; i < Entries.size(); i++)
+		{
+			const keyslot &e = Entries[i];
+			size_t k = e.hash & mask;
+			if(k < lo || k >= hi)
+				continue;
+
+			for(; k < hi; k++)
+			{
+				keyslot &x = this->Index[k];
+				if(x.sec < 0)
+				{
+					x = e;
+					Count[r]++;
+					Sum[r] += LayoutTerm(e);
+					break;
+				}
+				if(x.hash == e.hash && (x.param < 0) == (e.param < 0) && this->Sections[x.sec].key == this->Sections[e.sec].key
+					&& (e.param < 0 || this->Params[x.param].name == this->Params[e.param].name))
+				{
+					Sum[r] += LayoutTerm(e) - LayoutTerm(x);
+					x = e;
+					Dup[r] = 1;
+					break;
+				}
+			}
+			if(k == hi)
+				Deferred[r].push_back(i);
+		}
+	});
+
+	vector<size_t> Rest;
+	for(size_t r = 0; r < R; r++)
+	{
+		this->IndexCount += Count[r];
+		this->Layout += Sum[r];
+		this->Duplicates = this->Duplicates || Dup[r];
+		Rest.insert(Rest.end(), Deferred[r].begin(), Deferred[r].end());
+	}
+	sort(Rest.begin(), Rest.end());
+	for(size_t i = 0; i < Rest.size(); i++)
+		this->IndexInsert(Entries[Rest[i]].sec, Entries[Rest[i]].param, Entries[Rest[i]].hash);
+
+	INI_COUNT(lines, this->Lines.Count());
+	this->Pristine = true;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Keep the index without the text of the INI file
+//!
+//! This function is for local using only. With the INI_INTERN flag, once
+//! the file is parsed, the section and parameter names are interned into
+//! the pool of the process (see INIInternPool), and the values and the
+//! texts of the lines are copied into one string of the parser. Then the
+//! text of the file is freed (or unmapped): the parsers of many files with
+//! the same names only keep their own values. The size and the hash of the
+//! text are kept, so Refresh() and Compile() still know whether the file
+//! has changed. The file is then always rewritten, never patched.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Compact()
+{
+	INIInternPool &Pool = INIInternPool::Global();
+	for(size_t i = 0; i < this->Sections.size(); i++)
+		this->Sections[i].key = Pool.Acquire(this->Sections[i].key);
+	for(size_t j = 0; j < this->Params.size(); j++)
+		this->Params[j].name = Pool.Acquire(this->Params[j].name);
+	this->Interned = true;
+
+	// the comments of the sections and of the parameters are in the text of their line
+	size_t total = 0;
+	for(int h = this->Lines.First(); h >= 0; h = this->Lines.Next(h))
+		total += this->Lines[h].text.size();
+	for(size_t j = 0; j < this->Params.size(); j++)
+		total += this->Params[j].value.size();
+
+	this->Strings.emplace_front(total, '\0');
+	char *c = &(this->Strings.front()[0]);
+	auto Copy = [&c](string_view v)
+	{
+		if(v.size() > 0)
+			memcpy(c, v.data(), v.size());
+		c += v.size();
+		return string_view(c - v.size(), v.size());
+	};
+
+	for(int h = this->Lines.First(); h >= 0; h = this->Lines.Next(h))
+	{
+		lineview &lv = this->Lines[h];
+		string_view Old = lv.text;
+		lv.text = Copy(Old);
+
+		string_view *Comment = NULL;
+		if(lv.param >= 0)
+			Comment = &(this->Params[lv.param].comment);
+		else if(lv.sec >= 0)
+			Comment = &(this->Sections[lv.sec].comment);
+		if(Comment != NULL)
+			*Comment = (lv.type == 2) ? lv.text.substr(Comment->data() - Old.data(), Comment->size()) : string_view();
+	}
+	for(size_t j = 0; j < this->Params.size(); j++)
+		this->Params[j].value = Copy(this->Params[j].value);
+
+	this->TextSize = this->Source.size();
+	this->TextHash = INIHash(this->Source);
+	this->Source = string_view();
+	this->Unmap();
+	string().swap(this->TextFile);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Read a scanned line
+//! \param    t          the text of the INI file
+//! \param    L          the line found by INIScan()
+//! \param    InSection  true if a section has been declared before the line
+//! \param    lv         receives the line (its section and parameter are -1)
+//! \param    s          receives the section declared by the line
+//! \param    p          receives the parameter declared by the line
+//! \return   1 for a section, 2 for a parameter, 0 for another line
+//! 
+//! This function is for local using only. The handles, the indexes and the
+//! links of the section or of the parameter are set by the caller.
+//!
+//--------------------------------------------------------------------------
+int __CALL INIParser::ParseLine(string_view t, const scanline &L, bool InSection, lineview &lv, sectionview &s, parameterview &p)
+{
+	lv.type = 1;
+	lv.sec = -1;
+	lv.param = -1;
+
+	string_view Comment;
+	if(L.comment != string_view::npos)
+	{
+		lv.type = 2;
+		lv.text = t.substr(L.comment, L.end - L.comment);
+		Comment = StrTrim(t.substr(L.comment + 1, L.end - L.comment - 1), 0);
+	}
+
+	if(L.comment == L.begin)
+	{
+		lv.type = 0;
+		return 0;
+	}
+
+	if(L.close != string_view::npos && L.close - L.open > 1)
+	{
+		s.key = t.substr(L.open + 1, L.close - L.open - 1);
+		s.comment = Comment;
+		s.first = -1;
+		s.last = -1;
+		return 1;
+	}
+
+	if(InSection && L.equal != string_view::npos && L.equal > L.begin)
+	{
+		p.name = StrTrim(t.substr(L.begin, L.equal - L.begin), 1);
+		p.value = StrTrim(t.substr(L.equal + 1, L.body - L.equal - 1), 0);
+		p.comment = Comment;
+		p.next = -1;
+		Uncache(p);
+		return 2;
+	}
+
+	// not a parameter, the line is kept as it is
+	lv.type = 0;
+	lv.text = t.substr(L.begin, L.end - L.begin);
+	return 0;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Add an entry to the key index
+//! \param    sec      the index of the section
+//! \param    param    the index of the parameter (-1 for the section itself)
+//! 
+//! This function is for local using only. The index is an open addressing
+//! hash table (linear probing) which is kept at most half full. If the
+//! section or the key is already indexed, the entry is replaced, so the
+//! last declaration of a key wins.
+//! The layout checksum is the sum of a hash of every entry, so it is
+//! updated with the entry and does not depend on the order of insertion
+//! (see INIKey).
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::IndexInsert(int sec, int param)
+{
+	string_view key = this->Sections[sec].key;
+
+	if(param < 0)
+		this->IndexInsert(sec, param, INIHashSection(key));
+	else
+		this->IndexInsert(sec, param, INIHashKey(key, this->Params[param].name));
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Add an entry to the key index
+//! \param    sec      the index of the section
+//! \param    param    the index of the parameter (-1 for the section itself)
+//! \param    hash     the hash of the names (see INIHashSection() and INIHashKey())
+//!
+//! This function is for local using only, when the hash has been computed
+//! before (see ParallelParse()).
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::IndexInsert(int sec, int param, unsigned long long hash)
+{
+	if(2 * (this->IndexCount + 1) > this->Index.size())
+	{
+		pmr::vector<keyslot> old(&this->Memory);
+		old.swap(this->Index);
+		keyslot empty = {0, -1, -1};
+		this->Index.assign(old.size() < 16 ? 32 : 2 * old.size(), empty);
+		size_t mask = this->Index.size() - 1;
+		for(unsigned int i = 0; i < old.size(); i++)
+		{
+			if(old[i].sec < 0)
+				continue;
+			size_t k = old[i].hash & mask;
+			while(this->Index[k].sec >= 0)
+				k = (k + 1) & mask;
+			this->Index[k] = old[i];
+		}
+	}
+
+	string_view key = this->Sections[sec].key;
+	keyslot e;
+	e.hash = hash;
+	e.sec = sec;
+	e.param = param;
+	if(param < 0)
+	{
+		int k = this->IndexFind(e.hash, key, "", true);
+		if(k >= 0)
+		{
+			this->Layout += LayoutTerm(e) - LayoutTerm(this->Index[k]);
+			this->Index[k] = e;
+			this->Duplicates = true;
+			return;
+		}
+	}
+	else
+	{
+		string_view name = this->Params[param].name;
+		int k = this->IndexFind(e.hash, key, name, false);
+		if(k >= 0)
+		{
+			this->Layout += LayoutTerm(e) - LayoutTerm(this->Index[k]);
+			this->Index[k] = e;
+			this->Duplicates = true;
+			return;
+		}
+	}
+
+	size_t mask = this->Index.size() - 1;
+	size_t k = e.hash & mask;
+	while(this->Index[k].sec >= 0)
+		k = (k + 1) & mask;
+	this->Index[k] = e;
+	this->Layout += LayoutTerm(e);
+	(this->IndexCount)++;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Remove an entry from the key index
+//! \param    k    the slot of the entry
+//! 
+//! This function is for local using only. The next entries of the probing
+//! sequence are moved back, so no slot is marked as deleted.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::IndexErase(int k)
+{
+	size_t mask = this->Index.size() - 1;
+	size_t i = k;
+	this->Layout -= LayoutTerm(this->Index[i]);
+	this->Index[i].sec = -1;
+	this->Index[i].param = -1;
+
+	for(size_t j = (i + 1) & mask; this->Index[j].sec >= 0; j = (j + 1) & mask)
+	{
+		// an entry can move back if its hash slot is not between the hole and itself
+		size_t home = this->Index[j].hash & mask;
+		if(((j - home) & mask) >= ((j - i) & mask))
+		{
+			this->Index[i] = this->Index[j];
+			this->Index[j].sec = -1;
+			this->Index[j].param = -1;
+			i = j;
+		}
+	}
+
+	(this->IndexCount)--;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Look for an entry in the key index
+//! \param    hash       the hash of the section (and key) to find
+//! \param    section    the section name
+//! \param    key        the parameter name (ignored for a section)
+//! \param    IsSection  true to find a section, false to find a parameter
+//! \return   an integer representing the slot of the entry in the index
+//! 
+//! This function is for local using only.
+//! 
+//! This function returns -1 if the entry cannot be found.
+//!
+//--------------------------------------------------------------------------
+int __CALL INIParser::IndexFind(unsigned long long hash, string_view section, string_view key, bool IsSection) const
+{
+	if(this->Index.size() == 0)
+		return -1;
+
+	size_t mask = this->Index.size() - 1;
+	for(size_t k = hash & mask; ; k = (k + 1) & mask)
+	{
+		const keyslot &e = this->Index[k];
+		if(e.sec < 0)
+			return -1;
+		if(e.hash != hash || (e.param < 0) != IsSection)
+			continue;
+
+		if(INISameName(this->Sections[e.sec].key, section) && (IsSection || INISameName(this->Params[e.param].name, key)))
+			return k;
+	}
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a section
+//! \param    section    the section name
+//! \return   a pointer to the section structure
+//! 
+//! This function looks for the section in the key index, so it costs one
+//! hash whatever the size of the INI file. If a section is declared several
+//! times in the INI file, the last one is returned.
+//! The returned pointer is valid until the INI file is modified or reopened.
+//! 
+//! This function returns NULL if the section cannot be found.
+//!
+//--------------------------------------------------------------------------
+const sectionview * __CALL INIParser::Find(string_view section) const
+{
+	int k = this->IndexFind(INIHashSection(section), section, "", true);
+
+	if(k < 0)
+	{
+		INI_COUNT(misses, 1);
+		return NULL;
+	}
+
+	INI_COUNT(hits, 1);
+	return &(this->Sections[this->Index[k].sec]);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a parameter
+//! \param    section    the section name
+//! \param    key        the parameter name
+//! \return   a pointer to the parameter structure
+//! 
+//! This function looks for the parameter in the key index, so it costs one
+//! hash whatever the size of the INI file. If a key is declared several
+//! times, the last one is returned.
+//! The returned pointer is valid until the INI file is modified or reopened.
+//! 
+//! This function returns NULL if the parameter cannot be found.
+//!
+//--------------------------------------------------------------------------
+const parameterview * __CALL INIParser::Find(string_view section, string_view key) const
+{
+	int k = this->IndexFind(INIHashKey(section, key), section, key, false);
+
+	if(k < 0)
+	{
+		INI_COUNT(misses, 1);
+		return NULL;
+	}
+
+	INI_COUNT(hits, 1);
+	return &(this->Params[this->Index[k].param]);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the line number of a section or a parameter
+//! \param    handle    the handle of the line (see sectionview and parameterview)
+//! \return   the line number in the INI file (0 for the first line)
+//! 
+//! The empty lines of the INI file are not counted. The line numbers
+//! change when parameters are added, the handles never change.
+//!
+//--------------------------------------------------------------------------
+int __CALL INIParser::GetLineNumber(int handle)
+{
+	return this->Lines.Line(handle);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the sections name of the INI File
+//! \return   a vector of strings with the sections name
+//! 
+//! This function returns the sections found when the INI file was parsed.
+//! 
+//! This function returns a vector of strings with the sections names.
+//!
+//--------------------------------------------------------------------------
+vector<string> __CALL INIParser::GetSectionsName() const
+{
+	INI_TIME(INI_PHASE_SECTIONS);
+	vector<string> Keys;
+	Keys.reserve(this->Sections.size());
+	for(unsigned int i = 0; i < this->Sections.size(); i++)
+		Keys.push_back(string(this->Sections[i].key));
+
+	return Keys;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the sections number of the INI File
+//! \return   an integer representing the sections number
+//! 
+//! This function returns an integer with the sections number.
+//!
+//--------------------------------------------------------------------------
+int __CALL INIParser::GetSectionNumber() const
+{
+	return this->Sections.size();
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a specified section of the INI File
+//! \param    SectionName  a char pointer for the section name of the INI file to get
+//! \return   a section structure
+//! 
+//! This function returns the specified section from the parsed dictionnary.
+//! 
+//! This function returns a section structure with the specified section.
+//! If the specified section cannot be foud, this function returns an empty section.
+//!
+//--------------------------------------------------------------------------
+section __CALL INIParser::GetSection(const char *SectionName)
+{
+	INI_TIME(INI_PHASE_SECTION);
+	const sectionview *f = this->Find(SectionName);
+
+	if(f == NULL)
+	{
+		section s;
+		s.key = "";
+		s.parameters.clear();
+		return s;
+	}
+
+	return this->MakeSection(*f);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Build a section structure
+//! \param    s    the section of the index
+//! \return   a section structure
+//! 
+//! This function is for local using only. It copies a section of the index
+//! and its parameters into a section structure.
+//!
+//--------------------------------------------------------------------------
+section __CALL INIParser::MakeSection(const sectionview &s)
+{
+	section sd;
+	sd.key = string(s.key);
+	sd.comment = string(s.comment);
+	sd.line = this->Lines.Line(s.handle);
+
+	for(int j = s.first; j >= 0; j = this->Params[j].next)
+	{
+		const parameterview &p = this->Params[j];
+		parameter pd;
+		pd.name = string(p.name);
+		pd.value = string(p.value);
+		pd.comment = string(p.comment);
+		pd.line = this->Lines.Line(p.handle);
+		sd.parameters.push_back(pd);
+	}
+
+	return sd;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the dictionnary of the INI File
+//! \return   a dictionnary structure
+//! 
+//! This function returns a dictionnary structure for the entire INI file
+//!
+//--------------------------------------------------------------------------
+dictionnary __CALL INIParser::GetDictionnary()
+{
+	this->Materialize();
+
+	return this->dico;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Build the dictionnary of the INI File
+//! 
+//! This function is for local using only. The dictionnary is built from
+//! the index the first time it is needed, and again after a modification.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Materialize()
+{
+	if(!this->DicoChanged)
+	{
+		INI_COUNT(dicohits, 1);
+		return;
+	}
+
+	INI_TIME(INI_PHASE_DICTIONNARY);
+	INI_COUNT(dicomisses, 1);
+	this->dico.sections.clear();
+	this->dico.Keys.clear();
+	for(unsigned int i = 0; i < this->Sections.size(); i++)
+	{
+		this->dico.sections.push_back(this->MakeSection(this->Sections[i]));
+		this->dico.Keys.push_back(this->dico.sections[i].key);
+	}
+
+	this->DicoChanged = false;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a boolean value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a boolean representing the value of the specified key
+//! 
+//! This function returns a boolean value for the specified key.
+//! If the value is "true" or 1, the returned value is true, false otherwise
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::GetBoolean(const char *section, const char *key)
+{
+	const parameterview *p = this->Convert(section, key, 2);
+
+	if(p == NULL)
+		return false;
+
+	return p->boolean;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a string value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a string representing the value of the specified key
+//! 
+//! This function returns a string value for the specified key.
+//!
+//--------------------------------------------------------------------------
+string __CALL INIParser::GetString(const char *section, const char *key)
+{
+	const parameterview *p = this->Find(section, key);
+
+	if(p == NULL)
+		return "";
+
+	return string(p->value);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get an integer value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   an integer representing the value of the specified key
+//! 
+//! This function returns an integer value for the specified key.
+//! If the value cannot be converted into integer, 0 is returned
+//!
+//--------------------------------------------------------------------------
+int __CALL INIParser::GetInteger(const char *section, const char *key)
+{
+	const parameterview *p = this->Convert(section, key, 0);
+
+	if(p == NULL)
+		return 0;
+
+	return int(p->integer);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a double value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a double representing the value of the specified key
+//! 
+//! This function returns a double value for the specified key.
+//! If the value cannot be converted into double, 0.0 is returned
+//!
+//--------------------------------------------------------------------------
+double __CALL INIParser::GetDouble(const char *section, const char *key)
+{
+	const parameterview *p = this->Convert(section, key, 1);
+
+	if(p == NULL)
+		return 0.0;
+
+	return p->real;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a boolean value, and whether it exists and is valid
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the boolean value of the specified key
+//! \return   INI_VALUE_OK, INI_VALUE_MISSING or INI_VALUE_MALFORMED
+//!
+//! The value is "true", "false", "1" or "0" (in any case). If the key does
+//! not exist or if its value is malformed, value is not modified, so it can
+//! be initialized with a default value.
+//!
+//--------------------------------------------------------------------------
+INIValueStatus __CALL INIParser::TryGetBoolean(const char *section, const char *key, bool &value)
+{
+	const parameterview *p = this->Convert(section, key, 2);
+
+	if(p == NULL)
+		return INI_VALUE_MISSING;
+
+	if(p->status[2] == INI_VALUE_OK)
+		value = p->boolean;
+	return (INIValueStatus)p->status[2];
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get an integer value, and whether it exists and is valid
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the integer value of the specified key
+//! \return   INI_VALUE_OK, INI_VALUE_MISSING or INI_VALUE_MALFORMED
+//!
+//! The whole value must be a decimal integer. If the key does not exist or
+//! if its value is malformed, value is not modified.
+//!
+//--------------------------------------------------------------------------
+INIValueStatus __CALL INIParser::TryGetInteger(const char *section, const char *key, long long &value)
+{
+	const parameterview *p = this->Convert(section, key, 0);
+
+	if(p == NULL)
+		return INI_VALUE_MISSING;
+
+	if(p->status[0] == INI_VALUE_OK)
+		value = p->integer;
+	return (INIValueStatus)p->status[0];
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a double value, and whether it exists and is valid
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the double value of the specified key
+//! \return   INI_VALUE_OK, INI_VALUE_MISSING or INI_VALUE_MALFORMED
+//!
+//! The whole value must be a number. If the key does not exist or if its
+//! value is malformed, value is not modified.
+//!
+//--------------------------------------------------------------------------
+INIValueStatus __CALL INIParser::TryGetDouble(const char *section, const char *key, double &value)
+{
+	const parameterview *p = this->Convert(section, key, 1);
+
+	if(p == NULL)
+		return INI_VALUE_MISSING;
+
+	if(p->status[1] == INI_VALUE_OK)
+		value = p->real;
+	return (INIValueStatus)p->status[1];
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Forget the converted values of a parameter
+//! \param    p    the parameter whose value is new
+//!
+//! This function is for local using only.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Uncache(parameterview &p)
+{
+	p.status[0] = INI_VALUE_UNKNOWN;
+	p.status[1] = INI_VALUE_UNKNOWN;
+	p.status[2] = INI_VALUE_UNKNOWN;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Convert the value of a parameter
+//! \param    param    the index of the parameter (-1 if it does not exist)
+//! \param    type     0 for an integer, 1 for a double, 2 for a boolean
+//! \return   the parameter (NULL if it does not exist)
+//!
+//! This function is for local using only. The value is converted the first
+//! time it is read with this type, then the next reads only load the
+//! converted value until the value is modified or parsed again.
+//!
+//--------------------------------------------------------------------------
+parameterview * __CALL INIParser::Convert(int param, int type)
+{
+	if(param < 0)
+		return NULL;
+
+	parameterview &p = this->Params[param];
+	if(p.status[type] == INI_VALUE_UNKNOWN)
+	{
+		INI_COUNT(valuemisses, 1);
+		if(type == 0)
+			p.status[0] = INIToInteger(p.value, p.integer);
+		else if(type == 1)
+			p.status[1] = INIToDouble(p.value, p.real);
+		else
+			p.status[2] = INIToBoolean(p.value, p.boolean);
+	}
+	else
+	{
+		INI_COUNT(valuehits, 1);
+	}
+
+	return &p;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a parameter and convert its value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    type       0 for an integer, 1 for a double, 2 for a boolean
+//! \return   the parameter (NULL if it does not exist)
+//!
+//! This function is for local using only.
+//!
+//--------------------------------------------------------------------------
+parameterview * __CALL INIParser::Convert(const char *section, const char *key, int type)
+{
+	int k = this->IndexFind(INIHashKey(section, key), section, key, false);
+
+	if(k < 0)
+		INI_COUNT(misses, 1);
+	else
+		INI_COUNT(hits, 1);
+
+	return this->Convert((k < 0) ? -1 : this->Index[k].param, type);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Resolve a key once for repeated reads
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   the resolved key (see INIKey)
+//!
+//! The names are not copied, so they must live as long as the key.
+//!
+//--------------------------------------------------------------------------
+INIKey __CALL INIParser::Resolve(const char *section, const char *key)
+{
+	INIKey k(section, key);
+
+	this->Resolve(k);
+	return k;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Resolve a key in the current layout of the key index
+//! \param    k    the key to resolve
+//! \return   true if the key exists
+//!
+//! The key remembers the index of its parameter and the layout of the key
+//! index. The reads with this key resolve it again only if the layout has
+//! changed since (a parameter or a section has been added or removed).
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::Resolve(INIKey &k)
+{
+	int i = this->IndexFind(k.hash, k.section, k.key, false);
+
+	INI_COUNT(keyresolves, 1);
+	k.param = (i < 0) ? -1 : this->Index[i].param;
+	k.layout = this->Layout;
+	return k.param >= 0;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the index of the parameter of a resolved key
+//! \param    k    the key
+//! \return   the index of the parameter (-1 if it does not exist)
+//!
+//! This function is for local using only.
+//!
+//--------------------------------------------------------------------------
+int __CALL INIParser::KeyParam(INIKey &k)
+{
+	INI_COUNT(keyreads, 1);
+	if(k.layout != this->Layout)
+		this->Resolve(k);
+
+	return k.param;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a parameter with a resolved key
+//! \param    k    the key (see Resolve())
+//! \return   a pointer to the parameter (NULL if it does not exist)
+//!
+//! The pointer is valid until the next modification of the parser.
+//!
+//--------------------------------------------------------------------------
+const parameterview * __CALL INIParser::Find(INIKey &k)
+{
+	int j = this->KeyParam(k);
+
+	if(j < 0)
+		return NULL;
+
+	return &(this->Params[j]);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a boolean value with a resolved key
+//! \param    k    the key (see Resolve())
+//! \return   a boolean representing the value of the key (see GetBoolean())
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::GetBoolean(INIKey &k)
+{
+	const parameterview *p = this->Convert(this->KeyParam(k), 2);
+
+	if(p == NULL)
+		return false;
+
+	return p->boolean;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a string value with a resolved key
+//! \param    k    the key (see Resolve())
+//! \return   a string representing the value of the key
+//!
+//--------------------------------------------------------------------------
+string __CALL INIParser::GetString(INIKey &k)
+{
+	const parameterview *p = this->Find(k);
+
+	if(p == NULL)
+		return "";
+
+	return string(p->value);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get an integer value with a resolved key
+//! \param    k    the key (see Resolve())
+//! \return   an integer representing the value of the key (see GetInteger())
+//!
+//--------------------------------------------------------------------------
+int __CALL INIParser::GetInteger(INIKey &k)
+{
+	const parameterview *p = this->Convert(this->KeyParam(k), 0);
+
+	if(p == NULL)
+		return 0;
+
+	return int(p->integer);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a double value with a resolved key
+//! \param    k    the key (see Resolve())
+//! \return   a double representing the value of the key (see GetDouble())
+//!
+//--------------------------------------------------------------------------
+double __CALL INIParser::GetDouble(INIKey &k)
+{
+	const parameterview *p = this->Convert(this->KeyParam(k), 1);
+
+	if(p == NULL)
+		return 0.0;
+
+	return p->real;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a string value without copying it
+//! \param    section    the section name
+//! \param    key        the parameter name
+//! \return   a view of the value of the specified key
+//!
+//! The view refers to the index of the parser, so it is valid until the
+//! INI file is modified or reopened. Nothing is allocated.
+//! If the key cannot be found, this function returns an empty view.
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INIParser::GetStringView(string_view section, string_view key) const
+{
+	const parameterview *p = this->Find(section, key);
+
+	if(p == NULL)
+		return string_view();
+
+	return p->value;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a string value without copying it, with a resolved key
+//! \param    k    the key (see Resolve())
+//! \return   a view of the value of the key (see GetStringView())
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INIParser::GetStringView(INIKey &k)
+{
+	const parameterview *p = this->Find(k);
+
+	if(p == NULL)
+		return string_view();
+
+	return p->value;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the sections of the index
+//! \return   a range of the sections (see INISectionRange)
+//!
+//! Unlike GetDictionnary(), nothing is copied: the names and the comments
+//! are views into the index, valid until the INI file is modified or
+//! reopened. A section declared several times appears several times.
+//!
+//--------------------------------------------------------------------------
+INISectionRange __CALL INIParser::GetSections() const
+{
+	INISectionRange r;
+	r.first = this->Sections.data();
+	r.last = r.first + this->Sections.size();
+
+	return r;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the parameters of a section of the index
+//! \param    s    a section of the index (see GetSections() and Find())
+//! \return   a range of the parameters (see INIParameterRange)
+//!
+//! Unlike GetSection(), nothing is copied, the range is valid until the
+//! INI file is modified or reopened.
+//!
+//--------------------------------------------------------------------------
+INIParameterRange __CALL INIParser::GetParameters(const sectionview &s) const
+{
+	INIParameterRange r;
+	r.params = this->Params.data();
+	r.first = s.first;
+
+	return r;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the parameters of a section of the index
+//! \param    section    the section name
+//! \return   a range of the parameters (see INIParameterRange)
+//!
+//! If the section cannot be found, this function returns an empty range.
+//!
+//--------------------------------------------------------------------------
+INIParameterRange __CALL INIParser::GetParameters(string_view section) const
+{
+	const sectionview *s = this->Find(section);
+
+	if(s == NULL)
+	{
+		INIParameterRange r;
+		r.params = this->Params.data();
+		r.first = -1;
+		return r;
+	}
+
+	return this->GetParameters(*s);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Read several values at once
+//! \param    Queries    an array of queries (see INIQuery)
+//! \param    Count      the number of queries
+//! \return   the number of values read
+//!
+//! Every query is read in one pass: its key is resolved if the layout of
+//! the key index has changed since the previous query (or if it is the
+//! first one), then the value is an indexed load, converted once (see
+//! TryGetInteger()). The variable of a query is only written if the value
+//! is valid, so it keeps its default value if the key is missing or if the
+//! value is malformed (an integer out of the range of an int is malformed).
+//! The status of every query is set.
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INIParser::Query(INIQuery *Queries, size_t Count)
+{
+	size_t n = 0;
+
+	for(size_t i = 0; i < Count; i++)
+	{
+		INIQuery &q = Queries[i];
+		int j = this->KeyParam(q.key);
+		if(j < 0)
+		{
+			q.status = INI_VALUE_MISSING;
+			continue;
+		}
+
+		const parameterview *p;
+		switch(q.type)
+		{
+			case INI_TYPE_STRING:
+				*(string *)q.value = string(this->Params[j].value);
+				q.status = INI_VALUE_OK;
+				break;
+
+			case INI_TYPE_VIEW:
+				*(string_view *)q.value = this->Params[j].value;
+				q.status = INI_VALUE_OK;
+				break;
+
+			case INI_TYPE_INT:
+			case INI_TYPE_LONG:
+				p = this->Convert(j, 0);
+				q.status = (INIValueStatus)p->status[0];
+				if(q.type == INI_TYPE_INT && q.status == INI_VALUE_OK && (p->integer < INT_MIN || p->integer > INT_MAX))
+					q.status = INI_VALUE_MALFORMED;
+				if(q.status != INI_VALUE_OK)
+					break;
+				if(q.type == INI_TYPE_INT)
+					*(int *)q.value = int(p->integer);
+				else
+					*(long long *)q.value = p->integer;
+				break;
+
+			case INI_TYPE_DOUBLE:
+				p = this->Convert(j, 1);
+				q.status = (INIValueStatus)p->status[1];
+				if(q.status == INI_VALUE_OK)
+					*(double *)q.value = p->real;
+				break;
+
+			default:
+				p = this->Convert(j, 2);
+				q.status = (INIValueStatus)p->status[2];
+				if(q.status == INI_VALUE_OK)
+					*(bool *)q.value = p->boolean;
+				break;
+		}
+
+		if(q.status == INI_VALUE_OK)
+			n++;
+	}
+
+	return n;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find the keys of a section beginning with a prefix
+//! \param    section    the section name
+//! \param    prefix     the beginning of the parameter names
+//! \return   a cursor on the keys, in the order of their names (see INIKeyCursor)
+//!
+//! The keys are found in the sorted key index, which is built by the first
+//! call and then kept while the sections and the parameters are the same
+//! (see INIKey), so a call costs O(log n) plus the keys walked. As with
+//! Find(), a key declared several times is found once (the last one).
+//! `parser->FindPrefix("db", "replica.")` finds `replica.1.host`,
+//! `replica.2.host`...
+//!
+//--------------------------------------------------------------------------
+INIKeyCursor __CALL INIParser::FindPrefix(string_view section, string_view prefix)
+{
+	return this->OrderRange(true, section, prefix, string_view(), true);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find the keys of a section between two names
+//! \param    section    the section name
+//! \param    from       the first parameter name (included)
+//! \param    to         the last parameter name (excluded, empty for no limit)
+//! \return   a cursor on the keys, in the order of their names (see FindPrefix())
+//!
+//--------------------------------------------------------------------------
+INIKeyCursor __CALL INIParser::FindRange(string_view section, string_view from, string_view to)
+{
+	return this->OrderRange(true, section, from, to, false);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find the keys of every section beginning with a prefix
+//! \param    prefix     the beginning of the parameter names
+//! \return   a cursor on the keys, in the order of their names then of their
+//!           sections (see FindPrefix())
+//!
+//--------------------------------------------------------------------------
+INIKeyCursor __CALL INIParser::FindAllPrefix(string_view prefix)
+{
+	return this->OrderRange(false, string_view(), prefix, string_view(), true);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find the keys of every section between two names
+//! \param    from       the first parameter name (included)
+//! \param    to         the last parameter name (excluded, empty for no limit)
+//! \return   a cursor on the keys, in the order of their names then of their
+//!           sections (see FindPrefix())
+//!
+//--------------------------------------------------------------------------
+INIKeyCursor __CALL INIParser::FindAllRange(string_view from, string_view to)
+{
+	return this->OrderRange(false, string_view(), from, to, false);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Build the sorted key index
+//!
+//! This function is for local using only. The parameters of the key index
+//! are sorted twice: by section name then parameter name (KeyOrder), and by
+//! parameter name then section name (NameOrder). The entries are indices,
+//! so they stay valid while the layout of the key index is the same.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::BuildOrder()
+{
+	if(this->OrderBuilt && this->OrderLayout == this->Layout)
+		return;
+
+	this->KeyOrder.clear();
+	for(size_t k = 0; k < this->Index.size(); k++)
+	{
+		const keyslot &e = this->Index[k];
+		if(e.sec >= 0 && e.param >= 0)
+			this->KeyOrder.push_back({e.sec, e.param});
+	}
+	this->NameOrder.assign(this->KeyOrder.begin(), this->KeyOrder.end());
+
+	const sectionview *S = this->Sections.data();
+	const parameterview *P = this->Params.data();
+	sort(this->KeyOrder.begin(), this->KeyOrder.end(), [S, P](const keyentry &a, const keyentry &b)
+	{
+		int c = S[a.sec].key.compare(S[b.sec].key);
+		return c < 0 || (c == 0 && P[a.param].name < P[b.param].name);
+	});
+	sort(this->NameOrder.begin(), this->NameOrder.end(), [S, P](const keyentry &a, const keyentry &b)
+	{
+		int c = P[a.param].name.compare(P[b.param].name);
+		return c < 0 || (c == 0 && S[a.sec].key < S[b.sec].key);
+	});
+
+	this->OrderLayout = this->Layout;
+	this->OrderBuilt = true;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a range of the sorted key index
+//! \param    BySection  true to search the keys of a section, false for every section
+//! \param    section    the section name (ignored for every section)
+//! \param    from       the first parameter name, or the prefix
+//! \param    to         the last parameter name (excluded, empty for no limit)
+//! \param    IsPrefix   true to find the names beginning with from (to is ignored)
+//! \return   a cursor on the keys
+//!
+//! This function is for local using only. Both bounds are found by a binary
+//! search.
+//!
+//--------------------------------------------------------------------------
+INIKeyCursor __CALL INIParser::OrderRange(bool BySection, string_view section, string_view from, string_view to, bool IsPrefix)
+{
+	this->BuildOrder();
+
+	const sectionview *S = this->Sections.data();
+	const parameterview *P = this->Params.data();
+	const keyentry *b, *e;
+	if(BySection)
+	{
+		b = this->KeyOrder.data();
+		e = b + this->KeyOrder.size();
+	}
+	else
+	{
+		b = this->NameOrder.data();
+		e = b + this->NameOrder.size();
+	}
+
+	// the keys of another section are before or after the range
+	if(BySection)
+	{
+		b = partition_point(b, e, [S, section](const keyentry &x) { return S[x.sec].key < section; });
+		e = partition_point(b, e, [S, section](const keyentry &x) { return S[x.sec].key == section; });
+	}
+
+	INIKeyCursor c;
+	c.sections = S;
+	c.params = P;
+	c.pos = partition_point(b, e, [P, from](const keyentry &x) { return P[x.param].name < from; });
+	if(IsPrefix)
+		c.last = partition_point(c.pos, e, [P, from](const keyentry &x) { return P[x.param].name.compare(0, from.size(), from) <= 0; });
+	else if(to.empty())
+		c.last = e;
+	else
+		c.last = partition_point(c.pos, e, [P, to](const keyentry &x) { return P[x.param].name < to; });
+
+	return c;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Writes the INI text of a dictionnary into a stream
+//! \param    d    the dictionnary pointer to convert (NULL for the parser index)
+//! \param    Out  the stream receiving the text
+//! 
+//! This function is for local using only. The lines of the INI file are
+//! written in one ordered pass: every entry of the line table knows the
+//! section or the parameter written on this line, and the table is walked
+//! in order. For a dictionnary, the line of every section and parameter is
+//! first reported into a table, so the time is linear in the size of the
+//! file.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Serialize(const dictionnary *d, ostream &Out)
+{
+	vector<int> SecAt;
+	vector<int> ParamAt;
+	size_t n = this->Lines.Count();
+
+	if(d != NULL)
+	{
+		SecAt.assign(n, -1);
+		ParamAt.assign(n, -1);
+		for(unsigned int i = 0; i < d->sections.size(); i++)
+		{
+			const section &s = d->sections[i];
+			for(unsigned int j = 0; j < s.parameters.size(); j++)
+			{
+				int l = s.parameters[j].line;
+				if(l >= 0 && l < (int)n)
+				{
+					SecAt[l] = i;
+					ParamAt[l] = j;
+				}
+			}
+		}
+		for(unsigned int i = 0; i < d->sections.size(); i++)
+		{
+			int l = d->sections[i].line;
+			if(l >= 0 && l < (int)n)
+			{
+				SecAt[l] = i;
+				ParamAt[l] = -1;
+			}
+		}
+	}
+
+	size_t l = 0;
+	for(int h = this->Lines.First(); h >= 0; h = this->Lines.Next(h), l++)
+	{
+		const lineview &L = this->Lines[h];
+		int sec = (d == NULL) ? L.sec : SecAt[l];
+		int param = (d == NULL) ? L.param : ParamAt[l];
+
+		if(L.type == 0)
+		{
+			Out << L.text << '\n';
+		}
+		else if(sec >= 0 && param < 0)
+		{
+			if(d == NULL)
+				Out << "\n[" << this->Sections[sec].key << ']' << L.text << '\n';
+			else
+				Out << "\n[" << d->sections[sec].key << ']' << L.text << '\n';
+		}
+		else if(param >= 0)
+		{
+			if(d == NULL)
+				Out << this->Params[param].name << " = " << this->Params[param].value << L.text << '\n';
+			else
+				Out << d->sections[sec].parameters[param].name << " = " << d->sections[sec].parameters[param].value << L.text << '\n';
+		}
+	}
+}
+
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Writes a dictionnary into an INI file
+//! \param    d    the dictionnary to write
+//! \param    File a char pointer to the INI file name
+//! \return   a boolean indicating if the writing operation is a success
+//! 
+//! This function needs a pointer to the specified dictionnary and a pointer 
+//! to the file name. If the file name pointer is NULL, the dictionnary is
+//! written into the previously opened file.
+//! 
+//! This function returns a boolean to indicate the success of the writing operation
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::WriteINI(const dictionnary *d, const char *File)
+{
+	if(File == NULL)
+		File = this->FileName;
+
+	if(d == NULL || File == NULL)
+		return false;
+
+	try
+	{
+		return this->WriteFile(File, d);
+	}
+	catch(...)
+	{
+		return false;
+	}
+
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Writes the INI file into a stream
+//! \param    Out  the stream receiving the text
+//! \return   a boolean indicating if the writing operation is a success
+//! 
+//! This function writes the parser index (with its modifications) as an
+//! INI text into the specified stream, line by line.
+//! 
+//! This function returns a boolean to indicate the success of the writing operation
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::WriteINI(ostream &Out)
+{
+	this->Serialize(NULL, Out);
+
+	return !Out.fail();
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Writes the INI file into a buffer
+//! \param    Buffer  a char pointer to the buffer receiving the text
+//! \param    Size    the size of the buffer
+//! \return   the size of the INI text
+//! 
+//! This function writes the parser index (with its modifications) as an
+//! INI text into the specified buffer. The text is not terminated by a null
+//! character, and it is truncated if the buffer is too small.
+//! 
+//! This function returns the size of the whole text, so a return value
+//! greater than Size means that the buffer is too small.
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INIParser::WriteINI(char *Buffer, size_t Size)
+{
+	INIArrayBuffer b(Buffer, Size);
+	ostream Out(&b);
+	this->Serialize(NULL, Out);
+
+	return b.count;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Compile the INI file into a binary image
+//! \param    File a char pointer to the name of the image (.inic)
+//! \return   a boolean indicating if the writing operation is a success
+//!
+//! The image is a snapshot of the parser (see INISnapshot): the strings,
+//! the key index and the converted values, stored with offsets only. It is
+//! opened again with INISnapshot::Open(), which maps it and can use it at
+//! once. The header keeps the size, the modification time and the hash of
+//! the INI file, so Open() detects a stale image.
+//! The compilation fails if the INI file has changed since it was parsed,
+//! or if the image would be larger than 4 GB.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::Compile(const char *File)
+{
+	INISnapshot Image(*this, this->Version.load(memory_order_acquire));
+	if(!Image.IsValid())
+		return false;
+
+	if(!this->Path.empty())
+	{
+		// without the time, INISnapshot::Open() compares the text
+		int64_t Time = 0;
+#if __linux__
+		struct stat st;
+		if(stat(this->Path.c_str(), &st) != 0)
+			return false;
+		Time = (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+		string Text;
+		if(!this->ReadText(this->Path.c_str(), Text))
+			return false;
+		INI_COUNT(bytesread, Text.size());
+
+		// the text must be the parsed one, or the one written since
+		if(this->Pristine)
+		{
+			// only the hash of the text of an interned index is kept (see Compact())
+			if(this->Interned ? (Text.size() != this->TextSize || INIHash(Text) != this->TextHash) : Text != this->Source)
+				return false;
+		}
+		else if(this->Patchable)
+		{
+			ostringstream Out;
+			this->Splice(Out);
+			if(Text != Out.str())
+				return false;
+		}
+		else
+		{
+			ostringstream Out;
+			this->Serialize(NULL, Out);
+			if(Text != Out.str())
+				return false;
+		}
+
+		Image.Seal(Text.size(), Time, INIHash(Text));
+	}
+	else
+	{
+		Image.Seal(0, 0, INIHash(""));
+	}
+
+	return this->WriteFile(File, NULL, &Image);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Writes a dictionnary into a file
+//! \param    File  a char pointer to the file name
+//! \param    d     the dictionnary to write (NULL for the parser index)
+//! \param    Image the image to write instead of the text (see Compile())
+//! \return   a boolean indicating if the writing operation is a success
+//! 
+//! This function is for local using only. The text is streamed into a
+//! temporary file in the same directory, which then replaces the file with
+//! rename(). So the readers of the file never see a half-written file, and
+//! a file mapped in memory by INI_MAPPED is never truncated under the index.
+//! A symbolic link is kept: the file it points to is replaced.
+//! If only values have been modified since the INI file was read, it is
+//! patched instead (see PatchFile()). With the INI_INPLACE flag, a patch of
+//! values of the same size is written in the file itself, so it is not
+//! atomic.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::WriteFile(const char *File, const dictionnary *d, const INISnapshot *Image)
+{
+	INI_TIME(INI_PHASE_WRITE);
+
+	// the values modified in the INI file are patched, otherwise it is rewritten
+	if(Image == NULL && this->Path == File)
+	{
+		if(d == NULL && this->Patchable && this->PatchFile(File))
+			return true;
+		this->Patchable = false;
+	}
+
+#if __linux__
+	string Target = WriteTarget(File);
+	string Temp = Target + ".XXXXXX";
+	int fd = mkstemp(&Temp[0]);
+	if(fd < 0)
+		return false;
+
+	// the new file keeps the permissions of the file it replaces
+	struct stat st;
+	if(stat(Target.c_str(), &st) == 0)
+		fchmod(fd, st.st_mode & 07777);
+	else
+		fchmod(fd, 0644);
+
+	bool success;
+	{
+		INIFileBuffer b(fd);
+		ostream Out(&b);
+		if(Image != NULL)
+			Out.write((const char *)Image->Data(), Image->Size());
+		else
+			this->Serialize(d, Out);
+		Out.flush();
+		success = !Out.fail();
+		INI_COUNT(byteswritten, b.count);
+	}
+
+	success = success && fsync(fd) == 0;
+	if(close(fd) != 0)
+		success = false;
+	if(success && rename(Temp.c_str(), Target.c_str()) == 0)
+	{
+		INI_COUNT(rewrites, 1);
+		return true;
+	}
+
+	unlink(Temp.c_str());
+	return false;
+#else
+	ofstream f;
+	f.open(File, (Image != NULL) ? ios::out | ios::binary : ios::out);
+	if(!f.is_open())
+		return false;
+	if(Image != NULL)
+		f.write((const char *)Image->Data(), Image->Size());
+	else
+		this->Serialize(d, f);
+	INI_COUNT(byteswritten, f.tellp());
+	f.close();
+
+	if(f.fail())
+		return false;
+
+	INI_COUNT(rewrites, 1);
+	return true;
+#endif
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Writes the text of the INI file with its modified values
+//! \param    Out  the stream receiving the text
+//!
+//! This function is for local using only. The text read from the file is
+//! written as it is, except the old values (see textpatch).
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Splice(ostream &Out)
+{
+	size_t pos = 0;
+	for(size_t i = 0; i < this->Patches.size(); i++)
+	{
+		const textpatch &tp = this->Patches[i];
+		Out << this->Source.substr(pos, tp.offset - pos) << this->Params[tp.param].value;
+		pos = tp.offset + tp.size;
+	}
+	Out << this->Source.substr(pos);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Record the version of the INI file which has been read
+//! \param    Known   true if the version of the file was found before reading it
+//! \param    Before  the version of the file before reading it
+//!
+//! This function is for local using only. The file can be patched if it has
+//! not changed while it was read, so the text is the content of the file.
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Track(bool Known, const fileversion &Before)
+{
+	this->Patches.clear();
+	this->Patchable = false;
+
+#if __linux__
+	if(Known && FileVersion(this->FileName, this->Written))
+		this->Patchable = SameVersion(Before, this->Written) && this->Written.size == this->Source.size();
+#endif
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Patch the INI file with the modified values
+//! \param    File  a char pointer to the file name (the file which has been read)
+//! \return   a boolean indicating if the file has been patched
+//!
+//! This function is for local using only. The text of the file is written
+//! into a temporary file with writev(), as the unchanged ranges of the text
+//! read from the file and the new values, without being copied, and the
+//! temporary file replaces the file (see WriteFile()).
+//! With the INI_INPLACE flag, if the new values have the same size as the
+//! ones in the file, they are written in place with pwrite(), so the cost
+//! depends on the modifications only. The file is then modified under its
+//! readers: they can read a partly patched file, and the values change in
+//! the files mapped by INI_MAPPED in other processes.
+//! The file is not patched if it has changed since it was read or written:
+//! this function returns false, and the file must be rewritten.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::PatchFile(const char *File)
+{
+#if __linux__
+	struct stat st;
+	fileversion v;
+	if(stat(File, &st) != 0)
+		return false;
+	MakeVersion(st, v);
+	if(!SameVersion(v, this->Written))
+		return false;
+
+	bool InPlace = (this->OpenFlags & INI_INPLACE) != 0;
+	for(size_t i = 0; i < this->Patches.size() && InPlace; i++)
+	{
+		const textpatch &tp = this->Patches[i];
+		if(tp.dirty && this->Params[tp.param].value.size() != tp.written)
+			InPlace = false;
+	}
+
+	size_t count = 0;
+	if(InPlace)
+	{
+		int fd = open(File, O_WRONLY | O_CLOEXEC);
+		if(fd < 0)
+			return false;
+
+		// the offset of a value in the file is moved by the values written before
+		bool success = true;
+		ptrdiff_t shift = 0;
+		for(size_t i = 0; i < this->Patches.size() && success; i++)
+		{
+			const textpatch &tp = this->Patches[i];
+			if(tp.dirty)
+			{
+				string_view value = this->Params[tp.param].value;
+				success = pwrite(fd, value.data(), value.size(), tp.offset + shift) == (ssize_t)value.size();
+				count += value.size();
+			}
+			shift += (ptrdiff_t)tp.written - (ptrdiff_t)tp.size;
+		}
+
+		success = success && fsync(fd) == 0 && FileVersion(fd, this->Written);
+		if(close(fd) != 0 || !success)
+			return false;
+	}
+	else
+	{
+		string Target = WriteTarget(File);
+		string Temp = Target + ".XXXXXX";
+		int fd = mkstemp(&Temp[0]);
+		if(fd < 0)
+			return false;
+		fchmod(fd, st.st_mode & 07777);
+
+		vector<iovec> v;
+		size_t pos = 0;
+		for(size_t i = 0; i <= this->Patches.size(); i++)
+		{
+			size_t end = (i < this->Patches.size()) ? this->Patches[i].offset : this->Source.size();
+			iovec e;
+			e.iov_base = (void *)(this->Source.data() + pos);
+			e.iov_len = end - pos;
+			if(e.iov_len > 0)
+				v.push_back(e);
+			if(i == this->Patches.size())
+				break;
+
+			string_view value = this->Params[this->Patches[i].param].value;
+			e.iov_base = (void *)value.data();
+			e.iov_len = value.size();
+			if(e.iov_len > 0)
+				v.push_back(e);
+			pos = end + this->Patches[i].size;
+		}
+		for(size_t i = 0; i < v.size(); i++)
+			count += v[i].iov_len;
+
+		bool success = WriteAll(fd, v) && fsync(fd) == 0 && FileVersion(fd, this->Written);
+		if(close(fd) != 0)
+			success = false;
+		if(!success || rename(Temp.c_str(), Target.c_str()) != 0)
+		{
+			unlink(Temp.c_str());
+			return false;
+		}
+	}
+
+	for(size_t i = 0; i < this->Patches.size(); i++)
+	{
+		textpatch &tp = this->Patches[i];
+		tp.written = this->Params[tp.param].value.size();
+		tp.dirty = false;
+	}
+	INI_COUNT(rewrites, 1);
+	INI_COUNT(byteswritten, count);
+
+	return true;
+#else
+	return false;
+#endif
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Set a boolean value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the value to set for the specified key
+//! \return   a boolean indicating if the writing operation is a success
+//! 
+//! This function needs a pointer to the specified dictionnary and a pointer 
+//! to the specified key. if the section doesn't exists, it will be created.
+//! If the key doesn't exist (but the section does), a new key is added to 
+//! the specified section.
+//! Then, the modified dictionnary is writted to the INI file if it exists
+//! (once by EndUpdate() if the value is set after BeginUpdate()), and a
+//! snapshot is published with the INI_SNAPSHOT flag.
+//! 
+//! This function returns a boolean to indicate the success of the writing operation
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIParser::SetValue(const char *section, const char *key, bool value)
+{
+	if(value)
+		return this->WriteValue(section, key, "true");
+	else
+		return this->WriteValue(section, key, "false");
+}
 
-//-------------------------------------------------------------------------
+//--------------------------------------------------------------------------
 //!
-//! \brief    Trim spaces in a string at start, end or both
-//! \param    strinit string to trim
-//! \param    mode    integer describing what part to trim (optionnal)
-//! \return   a string representing the trimmed string
+//! \brief Set an integer value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the value to set for the specified key
+//! \return   a boolean indicating if the writing operation is a success
 //! 
-//! This function trims spaces and tabulations which are at start and at end of a string
-//! mode is an integer which could be :
-//!    0 : trims the start of the string
-//!    1 : trims the end of the string
-//!   -1 : trims the start and the end of the string (default)
+//! This function needs a pointer to the specified dictionnary and a pointer 
+//! to the specified key. if the section doesn't exists, it will be created.
+//! If the key doesn't exist (but the section does), a new key is added to 
+//! the specified section.
+//! Then, the modified dictionnary is writted to the INI file if it exists
+//! (once by EndUpdate() if the value is set after BeginUpdate()), and a
+//! snapshot is published with the INI_SNAPSHOT flag.
 //! 
-//! This function returns the trimmed string.
+//! This function returns a boolean to indicate the success of the writing operation
 //!
 //--------------------------------------------------------------------------
-string __CALL INIParser::StrTrim(string strinit, int mode)
+bool __CALL INIParser::SetValue(const char *section, const char *key, int value)
 {
-	if(mode == 0)
-	{
-		while(strinit.substr(0, 1) == " " || strinit.substr(0, 1) == "\t")
-			strinit.erase(0, 1);
-	}
-	else if(mode == 1)
-	{
-		while(strinit.substr(strinit.size() - 1, 1) == " " || strinit.substr(strinit.size() - 1, 1) == "\t")
-			strinit.erase(strinit.size() - 1, 1);
-	}
-	else
-	{
-		while(strinit.substr(0, 1) == " " || strinit.substr(0, 1) == "\t")
-			strinit.erase(0, 1);
-		while(strinit.substr(strinit.size() - 1, 1) == " " || strinit.substr(strinit.size() - 1, 1) == "\t")
-			strinit.erase(strinit.size() - 1, 1);
-	}
-	return strinit;
+	return this->WriteValue(section, key, this->NumToStr(value));
 }
 
-//-------------------------------------------------------------------------
+//--------------------------------------------------------------------------
 //!
-//! \brief    Convert a string in lowercase
-//! \param    strinit string to convert
-//! \return   a string representing the converted string
+//! \brief Set a double value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the value to set for the specified key
+//! \param    precision  the number of digits after point (default = 6)
+//! \return   a boolean indicating if the writing operation is a success
 //! 
-//! This function converts all characters of a string into their lowercase.
+//! This function needs a pointer to the specified dictionnary and a pointer 
+//! to the specified key. if the section doesn't exists, it will be created.
+//! If the key doesn't exist (but the section does), a new key is added to 
+//! the specified section.
+//! Then, the modified dictionnary is writted to the INI file if it exists
+//! (once by EndUpdate() if the value is set after BeginUpdate()), and a
+//! snapshot is published with the INI_SNAPSHOT flag.
 //! 
-//! This function returns the lowercase converted string.
+//! This function returns a boolean to indicate the success of the writing operation
 //!
 //--------------------------------------------------------------------------
-string __CALL INIParser::StrLower(string strinit)
+bool __CALL INIParser::SetValue(const char *section, const char *key, double value, int precision)
 {
-	// transforme une std::string en char*
-	char *str = new char[strinit.length() + 1];
-	copy(strinit.begin(), strinit.end(), str);
-	str[strinit.length()] = '\0';
-
-	for(unsigned int i = 0; i < strinit.length(); i++)
-	{
-		if(str[i] <= 'Z' && str[i] >= 'A')
-			str[i] -= ('Z' - 'z');
-	}
-
-	return string(str);
+	return this->WriteValue(section, key, this->NumToStr(value, precision));
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief   Convert an integer in a string
-//! \param   value integer to convert
-//! \return  a string representing the converted value
+//! \brief Set a string value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the value to set for the specified key
+//! \return   a boolean indicating if the writing operation is a success
 //! 
-//! this function converts an integer to a string.
+//! This function needs a pointer to the specified dictionnary and a pointer 
+//! to the specified key. if the section doesn't exists, it will be created.
+//! If the key doesn't exist (but the section does), a new key is added to 
+//! the specified section.
+//! Then, the modified dictionnary is writted to the INI file if it exists
+//! (once by EndUpdate() if the value is set after BeginUpdate()), and a
+//! snapshot is published with the INI_SNAPSHOT flag.
 //! 
-//! this function returns the converted string.
+//! This function returns a boolean to indicate the success of the writing operation
 //!
 //--------------------------------------------------------------------------
-string __CALL INIParser::NumToStr(int value)
+bool __CALL INIParser::SetValue(const char *section, const char *key, string value)
 {
-	if (value == 0)
-		return "0";
-
-	string temp="";
-	string returnvalue="";
-	while (value > 0)
-	{
-		temp += value % 10 + 48;
-		value /= 10;
-	}
-	for(int i = 0; i < temp.length(); i++)
-		returnvalue += temp[temp.length() - i - 1];
-
-	return returnvalue;
+	return this->WriteValue(section, key, value);
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief   Convert a double in a string
-//! \param   value double to convert
-//! \param   precision integer representing the decimal number after point (default = 6)
-//! \return  a string representing the converted value
+//! \brief Set a converted string value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the value to set for the specified key
+//! \return   a boolean indicating if the writing operation is a success
 //! 
-//! this function converts a double to a string with a specified decimal number.
+//! This function needs a pointer to the specified dictionnary and a pointer 
+//! to the specified key. if the section doesn't exists, it will be created.
+//! If the key doesn't exist (but the section does), a new key is added to 
+//! the specified section.
+//! Then, the modified dictionnary is writted to the INI file if it exists
+//! (once by EndUpdate() if the value is set after BeginUpdate()), and a
+//! snapshot is published with the INI_SNAPSHOT flag.
 //! 
-//! this function returns the converted string.
+//! This function returns a boolean to indicate the success of the writing operation
 //!
 //--------------------------------------------------------------------------
-string __CALL INIParser::NumToStr(double value, int precision)
+bool __CALL INIParser::WriteValue(const char *section, const char *parameter, string value)
 {
-	if (value == 0.0)
-		return "0.0";
-
-	string temp="";
-	string returnvalue="";
+	bool success = false;
 
-	int IntPart = int(value);
-	while (IntPart > 0)
+	int k = this->IndexFind(INIHashKey(section, parameter), section, parameter, false);
+	if(k >= 0)
 	{
-		temp += IntPart % 10 + 48;
-		IntPart /= 10;
+		int j = this->Index[k].param;
+		parameterview &p = this->Params[j];
+
+		// the old value is replaced in the text when the file is written
+		if(this->Patchable)
+		{
+			const char *t = this->Source.data();
+			if(p.value.data() >= t && p.value.data() + p.value.size() <= t + this->Source.size())
+			{
+				textpatch tp;
+				tp.offset = p.value.data() - t;
+				tp.size = p.value.size();
+				tp.written = tp.size;
+				tp.param = j;
+				tp.dirty = true;
+				vector<textpatch>::iterator at = lower_bound(this->Patches.begin(), this->Patches.end(), tp,
+					[](const textpatch &a, const textpatch &b) { return a.offset < b.offset; });
+				this->Patches.insert(at, tp);
+			}
+			else
+			{
+				size_t i = 0;
+				while(i < this->Patches.size() && this->Patches[i].param != j)
+					i++;
+				if(i < this->Patches.size())
+					this->Patches[i].dirty = true;
+				else
+					this->Patchable = false;
+			}
+		}
+
+		p.value = this->StrStore(value);
+		this->Uncache(p);
 	}
-	for(int i = 0; i < temp.length(); i++)
-		returnvalue += temp[temp.length() - i - 1];
+	else if((k = this->IndexFind(INIHashSection(section), section, "", true)) >= 0)
+	{
+		int i = this->Index[k].sec;
+		sectionview &s = this->Sections[i];
+		parameterview p;
+		lineview lv;
+		p.name = this->StrName(parameter);
+		p.value = this->StrStore(value);
+		p.next = -1;
+		this->Uncache(p);
+		int j = this->Params.size();
+		lv.type = 1;
+		lv.sec = i;
+		lv.param = j;
+		if(s.last < 0)
+			p.handle = this->Lines.InsertAfter(s.handle, lv);
+		else
+			p.handle = this->Lines.InsertAfter(this->Params[s.last].handle, lv);
+		this->Params.push_back(p);
 
-	temp = "";
-	value = double(value) - int(value);
-	value *= pow(10.0, precision);
-	int DecPart = int(value);
-	for(int i = 0; i < precision; i++)
+		if(s.last >= 0)
+			this->Params[s.last].next = j;
+		else
+			s.first = j;
+		s.last = j;
+		this->IndexInsert(i, j);
+		this->Patchable = false;
+	}
+	else
 	{
-		temp += DecPart % 10 + 48;
-		DecPart /= 10;
+		sectionview s;
+		parameterview p;
+		lineview lv;
+		int i = this->Sections.size();
+		int j = this->Params.size();
+		lv.type = 1;
+		lv.sec = i;
+		lv.param = -1;
+		s.key = this->StrName(section);
+		s.handle = this->Lines.Append(lv);
+
+		lv.param = j;
+		p.name = this->StrName(parameter);
+		p.value = this->StrStore(value);
+		p.next = -1;
+		this->Uncache(p);
+		p.handle = this->Lines.Append(lv);
+
+		this->Params.push_back(p);
+		s.first = j;
+		s.last = j;
+		this->Sections.push_back(s);
+		this->IndexInsert(i, -1);
+		this->IndexInsert(i, j);
+		this->Patchable = false;
 	}
-	returnvalue += ".";
-	for(int i = 0; i < temp.length(); i++)
-		returnvalue += temp[temp.length() - i - 1];
-
-	return returnvalue;
-}
-
-//-------------------------------------------------------------------------
-//!
-//! \brief    Returns the lines in the INI File
-//! \return   a vector of strings representing lines
-//! 
-//! This function returns a vector of strings for lines in the INI file.
-//!
-//--------------------------------------------------------------------------
-vector<string> __CALL INIParser::GetLines()
-{
-	vector<string> v;
-	v.clear();
 
-	// transforme une std::string en char*
-	char *str = new char[this->TextFile.length() + 1];
-	copy(this->TextFile.begin(), this->TextFile.end(), str);
-	str[this->TextFile.length()] = '\0';
+	this->DicoChanged = true;
+	this->Pristine = false;
 
-	char *pch;
-	pch = strtok (str,"\n\r");
-	while (pch != NULL)
+	if(this->UpdateCount > 0)
 	{
-		v.push_back(string(pch));
-		pch = strtok (NULL, "\n\r");
+		this->Modified = true;
+		return true;
 	}
 
-	this->FileEndLine = v.size();
-	if(this->EndLine == 0)
-		this->EndLine = this->FileEndLine;
-	
-	return v;
+	if(this->AutoPublish)
+		this->Publish();
+	if(this->FileName != NULL)
+		success = this->WriteFile(this->FileName, NULL);
+
+	return success;
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get the type of lines in the INI file
+//! \brief Begin an update of the INI file
 //! 
-//! This function is for local using only. Types are follow :
-//!    0 : comment line
-//!    1 : key or parameter
-//!    2 : key or parameter with comment
+//! After this function, SetValue() only modifies the parser and the INI
+//! file is not written anymore. It is written once, when EndUpdate() is
+//! called as many times as BeginUpdate() (updates can be nested).
+//! See also the INIUpdate class.
 //!
 //--------------------------------------------------------------------------
-void __CALL INIParser::GetLinesType()
+void __CALL INIParser::BeginUpdate()
 {
-	vector<string> L = this->GetLines();
-	this->LinesType->clear();
-	this->Comments->clear();
-
-	for(unsigned int i = 0; i < L.size(); i++)
-	{
-
-		L[i] = this->StrTrim(L[i], -1);
-
-		int p = -1;
-		int psharp = L[i].find_first_of("#", 0);
-		unsigned int s = L[i].size();
-		if(psharp >= 0 && psharp < L[i].size())
-			p = psharp;
-		int pcomma = L[i].find_first_of(";", 0);
-		if(pcomma >= 0 && pcomma < L[i].size())
-			p = pcomma;
-
-		if(p == 0)
-			this->LinesType->push_back(0);
-		else if(p == -1)
-			this->LinesType->push_back(1);
-		else if(p > 0)
-			this->LinesType->push_back(2);
-
-		comment c;
-		if(p >= 0)
-			c.text = L[i].substr(p, L[i].size() - p);
-		else
-			c.text = "";
-		c.line = i;
-		this->Comments->push_back(c);
-	}
-	
+	(this->UpdateCount)++;
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get the sections name of the INI File
-//! \return   a vector of strings with the sections name
+//! \brief End an update of the INI file
+//! \return   a boolean indicating if the writing operation is a success
 //! 
-//! This function read the lines of the INI file and peacks up sections.
+//! This function ends an update started with BeginUpdate(). At the end of
+//! the outermost update, if a value has been set, the INI file is written
+//! once (into a temporary file which replaces it), and a snapshot is
+//! published with the INI_SNAPSHOT flag.
 //! 
-//! This function returns a vector of strings with the sections names.
+//! This function returns a boolean to indicate the success of the writing operation
+//! (true if the file does not need to be written).
 //!
 //--------------------------------------------------------------------------
-vector<string> __CALL INIParser::GetSectionsName()
+bool __CALL INIParser::EndUpdate()
 {
-	if(this->Keys->size() == 0)
-	{
-		this->KeysLines->clear();
-
-		vector<string> p = this->GetLines();
+	if(this->UpdateCount == 0)
+		return false;
 
-		for(unsigned int i = 0; i < p.size(); i++)
-		{
-			p[i] = this->StrTrim(p[i], -1);
+	(this->UpdateCount)--;
+	if(this->UpdateCount > 0 || !this->Modified)
+		return true;
 
-			// transforme une std::string en char*
-			char *str = new char[p[i].length() + 1];
-			copy(p[i].begin(), p[i].end(), str);
-			str[p[i].length()] = '\0';
+	if(this->AutoPublish)
+		this->Publish();
+	if(this->FileName == NULL)
+		return true;
 
-			char *pch;
-			if(str[0] == '[' && str[p[i].length() - 1] == ']')
-			{
-				pch = strtok (str,"[]");
-				while (pch != NULL)
-				{
-					this->Keys->push_back(string(pch));
-					pch = strtok (NULL, "[]");
-					this->KeysLines->push_back(i);
-				}
-			}
-		}
-	}
+	if(!this->WriteFile(this->FileName, NULL))
+		return false;
 
-	return *(this->Keys);
+	this->Modified = false;
+	return true;
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get the sections number of the INI File
-//! \return   an integer representing the sections number
+//! \brief Publish a snapshot of the INI file
 //! 
-//! This function returns an integer with the sections number.
+//! This function builds a read-only snapshot of the index (see INISnapshot)
+//! and replaces the previous one atomically, then increments the version
+//! of the parser. The readers which hold the previous snapshot keep it
+//! until they release it.
+//! The versions are published in turn into two slots (see publishslot),
+//! so the new snapshot goes into the slot which the readers of the current
+//! version do not use. Only the readers still copying the snapshot two
+//! versions older are waited for: the readers never take a lock, and the
+//! ones arriving meanwhile try again with the new version.
+//! This function must be called by the thread which modifies the parser.
+//! It is called automatically with the INI_SNAPSHOT flag.
+//! An index too large for a snapshot (4 GB) is not published: the readers
+//! keep the previous snapshot.
 //!
 //--------------------------------------------------------------------------
-int __CALL INIParser::GetSectionNumber()
+void __CALL INIParser::Publish()
 {
-	if(this->Keys->size() == 0)
-		this->GetSectionsName();
-
-	return this->Keys->size();
+	unsigned long v = this->Version.load(memory_order_relaxed) + 1;
+	shared_ptr<const INISnapshot> s(new INISnapshot(*this, v));
+	if(!s->IsValid())
+		return;
+
+	// a reader counted before the slot is closed is waited for, a reader
+	// counted after sees that the slot is closed
+	publishslot &p = this->Published[v & 1];
+	p.version.store(0);
+	while(p.readers.load() != 0)
+		this_thread::yield();
+	p.snapshot.swap(s);
+	p.version.store(v, memory_order_release);
+	this->Version.store(v, memory_order_release);
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get a specified section of the INI File
-//! \param    SectionName  a char pointer for the section name of the INI file to get
-//! \return   a section structure
+//! \brief Get the last published snapshot
+//! \return   a shared pointer to the snapshot (empty if none has been published)
 //! 
-//! This function read the lines of the INI file and peacks up the specified section.
-//! 
-//! This function returns a section structure with the specified section.
-//! If the specified section cannot be foud, this function returns an empty section.
+//! Unlike the other methods of the parser, this function can be called by
+//! any thread while the parser is modified or reopened. It never takes a
+//! lock: if the slot of the last version is being replaced by Publish(),
+//! the version is loaded again. A thread reading often should use an
+//! INISnapshotReader, which only calls this function when a new snapshot
+//! has been published.
 //!
 //--------------------------------------------------------------------------
-section __CALL INIParser::GetSection(const char *SectionName)
+shared_ptr<const INISnapshot> __CALL INIParser::Snapshot()
 {
-	vector<string> p = this->GetLines();
-	int KNumber = -1;
-
-	section s;
-	s.key = "";
-	s.parameters.clear();
-
-	for(int i = 0; i < this->GetSectionNumber(); i++)
-	{
-		if(string(SectionName) == this->Keys->at(i))
-			KNumber = i;
-	}
-
-	if(KNumber < 0)
-		return s;
-
-	s.key = string(SectionName);
-	s.line = this->KeysLines->at(KNumber);
-
-	unsigned int EndLine;
-	if(KNumber >= this->KeysLines->size() - 1)
-		EndLine = p.size();
-	else
-		EndLine = this->KeysLines->at(KNumber + 1);
-
-	for(unsigned int i = 0; i < p.size(); i++)
+	for(;;)
 	{
-		if(i >= EndLine)
-			break;
-
-		if(i >= this->KeysLines->at(KNumber) + 1)
-		{
-			parameter sp;
-
-			p[i] = this->StrTrim(p[i], -1);
-
-			// transforme une std::string en char*
-			char *str = new char[p[i].length() + 1];
-			copy(p[i].begin(), p[i].end(), str);
-			str[p[i].length()] = '\0';
-
-			char *pch;
-			if(str[0] != '#' && str[0] != '\n' && str[0] != ';')
-			{
-				pch = strtok (str,"=");
-				if(pch != NULL)
-				{
-					sp.name = this->StrTrim(string(pch), -1);
-					pch = strtok (NULL, "=#;");
-					sp.value = this->StrTrim(string(pch), -1);
-					pch = strtok (NULL, "#;");
-					if(pch != NULL)
-						sp.comment = this->StrTrim(string(pch), -1);
-					sp.line = i;
-					s.parameters.push_back(sp);
-				}
-			}
-		}
+		unsigned long v = this->Version.load();
+		if(v == 0)
+			return NULL;
+
+		publishslot &p = this->Published[v & 1];
+		shared_ptr<const INISnapshot> s;
+		p.readers.fetch_add(1);
+		if(p.version.load() == v)
+			s = p.snapshot;
+		p.readers.fetch_sub(1, memory_order_release);
+		if(s)
+			return s;
 	}
-
-	return s;
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get the dictionnary of the INI File
-//! \return   a dictionnary structure
+//! \brief Get the version of the last published snapshot
+//! \return   the number of snapshots published by the parser
 //! 
-//! This function returns a dictionnary structure for the entire INI file
+//! This function can be called by any thread.
 //!
 //--------------------------------------------------------------------------
-dictionnary __CALL INIParser::GetDictionnary()
+unsigned long __CALL INIParser::GetVersion()
 {
-	if(this->dico->sections.size() == 0)
-	{
-		if(this->Keys->size() == 0)
-			this->GetSectionsName();
-
-		for(unsigned int i = 0; i < this->Keys->size(); i++)
-		{
-			this->dico->sections.push_back(this->GetSection(this->Keys->at(i).c_str()));
-		}
-	}
-
-	return *(this->dico);
+	return this->Version.load(memory_order_acquire);
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get a boolean value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \return   a boolean representing the value of the specified key
+//! \brief Watch the changes of the INI file
+//! \return   a boolean indicating if the file is watched
 //! 
-//! This function returns a boolean value for the specified key.
-//! If the value is "true" or 1, the returned value is true, false otherwise
+//! This function asks the system (inotify, only available on GNU/Linux) to
+//! report the writes of the INI file, and the files renamed to its name, so
+//! the replacement of the file by an editor or by WriteINI() is seen too.
+//! The changes are applied by Refresh(). The handle returned by
+//! GetWatchHandle() becomes readable when the file has changed, so it can be
+//! added to the poll() or epoll() loop of the program.
+//! The file is not watched anymore if another file is opened.
+//! 
+//! This function returns false if the file cannot be watched.
 //!
 //--------------------------------------------------------------------------
-bool __CALL INIParser::GetBoolean(const char *section, const char *key)
+bool __CALL INIParser::Watch()
 {
-	bool v = false;
+	this->Unwatch();
+	if(this->FileName == NULL)
+		return false;
+
+#if __linux__
+	string Dir = ".";
+	this->WatchName = this->Path;
+	size_t k = this->Path.find_last_of('/');
+	if(k != string::npos)
+	{
+		Dir = (k == 0) ? "/" : this->Path.substr(0, k);
+		this->WatchName = this->Path.substr(k + 1);
+	}
 
-	struct section s;
-	s.key = "";
-	s.parameters.clear();
-	s = this->GetSection(section);
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if(fd < 0)
+		return false;
 
-	for(unsigned int i = 0; i < s.parameters.size(); i++)
+	// the directory is watched, as the file may be replaced by another one
+	if(inotify_add_watch(fd, Dir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
 	{
-		if(s.parameters[i].name == string(key))
-		{
-			if(this->StrLower(s.parameters[i].value) == "true" || s.parameters[i].value == "1")
-				v = true;
-			else
-				v = false;
-		}
+		close(fd);
+		return false;
 	}
 
-	return v;
+	this->WatchHandle = fd;
+	return true;
+#else
+	return false;
+#endif
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get a string value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \return   a string representing the value of the specified key
+//! \brief Stop watching the changes of the INI file
+//!
+//--------------------------------------------------------------------------
+void __CALL INIParser::Unwatch()
+{
+#if __linux__
+	if(this->WatchHandle >= 0)
+		close(this->WatchHandle);
+#endif
+	this->WatchHandle = -1;
+	this->WatchName = "";
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the handle of the watch of the INI file
+//! \return   the file descriptor of the watch (-1 if the file is not watched)
 //! 
-//! This function returns a string value for the specified key.
+//! The descriptor becomes readable when the file has changed, then
+//! Refresh() must be called. It must not be read or closed by the caller.
 //!
 //--------------------------------------------------------------------------
-string __CALL INIParser::GetString(const char *section, const char *key)
+int __CALL INIParser::GetWatchHandle()
 {
-	struct section s;
-	s.key = "";
-	s.parameters.clear();
-	s = this->GetSection(section);
-
-	for(unsigned int i = 0; i < s.parameters.size(); i++)
-	{
-		if(s.parameters[i].name == string(key))
-		{
-			return s.parameters[i].value.c_str();
-		}
-	}
-
-	return "";
+	return this->WatchHandle;
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get an integer value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \return   an integer representing the value of the specified key
+//! \brief Apply the changes of the INI file
+//! \return   a boolean indicating if the index has changed
 //! 
-//! This function returns an integer value for the specified key.
-//! If the value cannot be converted into integer, 0 is returned
+//! If the file is watched (see Watch()), this function reads the pending
+//! events and does nothing if the file has not changed. Otherwise, the file
+//! is read again and compared with the text already parsed: only the
+//! sections containing the changed characters are parsed again, so the
+//! cost of a small change does not depend on the number of sections.
+//! The whole file is parsed again (as by Open()) when it has been opened
+//! with the INI_MAPPED, INI_ARENA or INI_INTERN flag, when a section or a
+//! key is declared several times, or after SetValue().
+//! Nothing is done during an update (see BeginUpdate()).
+//! A snapshot is published with the INI_SNAPSHOT flag.
+//! 
+//! This function returns false if the file is unchanged or cannot be read,
+//! the index is then unchanged.
 //!
 //--------------------------------------------------------------------------
-int __CALL INIParser::GetInteger(const char *section, const char *key)
+bool __CALL INIParser::Refresh()
 {
-	int v = 0;
-
-	struct section s;
-	s.key = "";
-	s.parameters.clear();
-	s = this->GetSection(section);
+	if(this->FileName == NULL || this->UpdateCount > 0)
+		return false;
 
-	for(unsigned int i = 0; i < s.parameters.size(); i++)
+#if __linux__
+	if(this->WatchHandle >= 0)
 	{
-		if(s.parameters[i].name == string(key))
+		bool changed = false;
+		char buffer[4096] __attribute__((aligned(__alignof__(struct inotify_event))));
+		ssize_t n;
+		while((n = read(this->WatchHandle, buffer, sizeof(buffer))) > 0)
 		{
-			try
+			for(char *q = buffer; q < buffer + n; )
 			{
-				v = int(strtod(s.parameters[i].value.c_str(), NULL));
+				const struct inotify_event *e = (const struct inotify_event *)q;
+				if((e->mask & IN_Q_OVERFLOW) || (e->len > 0 && this->WatchName == e->name))
+					changed = true;
+				q += sizeof(struct inotify_event) + e->len;
 			}
-			catch(...)
-			{}
 		}
+
+		if(!changed)
+			return false;
 	}
+#endif
 
-	return v;
+	return this->Reload();
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Get a double value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \return   a double representing the value of the specified key
+//! \brief Parse again the changed sections of the INI file
+//! \return   a boolean indicating if the index has changed
 //! 
-//! This function returns a double value for the specified key.
-//! If the value cannot be converted into double, 0.0 is returned
+//! This function is for local using only. The common beginning and end of
+//! the old and the new text are skipped, then the changed characters are
+//! extended to whole sections: from the start of the last section starting
+//! before the first change, to the start of the first section starting
+//! after the last change. Only these lines are parsed again. The sections,
+//! the parameters and the lines before and after them are kept, their
+//! views are moved into the new text and their indexes are shifted.
 //!
 //--------------------------------------------------------------------------
-double __CALL INIParser::GetDouble(const char *section, const char *key)
+bool __CALL INIParser::Reload()
 {
-	double v = 0.0;
+	INI_TIME(INI_PHASE_RELOAD);
+
+	string File = this->Path;
+	if(this->OpenFlags & INI_MAPPED)
+		return this->Open(File.c_str(), this->OpenFlags);
+
+	fileversion Before = fileversion();
+	bool Known = false;
+#if __linux__
+	Known = FileVersion(File.c_str(), Before);
+#endif
+	string Text;
+	if(!this->ReadText(File.c_str(), Text))
+		return false;
+	INI_COUNT(bytesread, Text.size());
+
+	string_view O = this->Source;
+	string_view N = Text;
+	bool Same = this->Interned ? (N.size() == this->TextSize && INIHash(N) == this->TextHash) : O == N;
+	if(this->Pristine && Same)
+	{
+		this->Track(Known, Before);
+		return false;
+	}
+	if(!this->Pristine || this->Duplicates || (this->OpenFlags & (INI_ARENA | INI_INTERN)))
+		return this->Open(File.c_str(), this->OpenFlags);
 
-	struct section s;
-	s.key = "";
-	s.parameters.clear();
-	s = this->GetSection(section);
+	size_t p = CommonPrefix(O, N);
+	size_t e = O.size() - CommonSuffix(O, N, min(O.size(), N.size()) - p);
+	ptrdiff_t delta = (ptrdiff_t)N.size() - (ptrdiff_t)O.size();
+
+	// the sections of the changed lines (sa to sb - 1)
+	int S = this->Sections.size();
+	int lo = 0, hi = S;
+	while(lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if(this->SectionOffset(mid) < p)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	int a = lo - 1;
+	hi = S;
+	while(lo < hi)
+	{
+		int mid = (lo + hi) / 2;
+		if(this->SectionOffset(mid) <= e)
+			lo = mid + 1;
+		else
+			hi = mid;
+	}
+	int sa = (a < 0) ? 0 : a;
+	int sb = lo;
+	size_t A = (a < 0) ? 0 : this->SectionOffset(a);
+	size_t E = (sb < S) ? this->SectionOffset(sb) : O.size();
 
-	for(unsigned int i = 0; i < s.parameters.size(); i++)
+	int pa = 0;
+	for(int i = sa - 1; i >= 0; i--)
 	{
-		if(s.parameters[i].name == string(key))
+		if(this->Sections[i].last >= 0)
 		{
-			try
-			{
-				v = strtod(s.parameters[i].value.c_str(), NULL);
-			}
-			catch(...)
-			{}
+			pa = this->Sections[i].last + 1;
+			break;
 		}
 	}
+	int pb = this->Params.size();
+	for(int i = sb; i < S; i++)
+	{
+		if(this->Sections[i].first >= 0)
+		{
+			pb = this->Sections[i].first;
+			break;
+		}
+	}
+	unsigned int LA = (a < 0) ? 0 : this->Lines.Line(this->Sections[sa].handle);
+	unsigned int LE = (sb < S) ? this->Lines.Line(this->Sections[sb].handle) : this->Lines.Count();
 
-	return v;
-}
+	// the old sections and parameters leave the key index
+	for(int i = sa; i < sb; i++)
+	{
+		const sectionview &s = this->Sections[i];
+		int k = this->IndexFind(INIHashSection(s.key), s.key, "", true);
+		if(k >= 0 && this->Index[k].sec == i)
+			this->IndexErase(k);
+		for(int j = s.first; j >= 0; j = this->Params[j].next)
+		{
+			k = this->IndexFind(INIHashKey(s.key, this->Params[j].name), s.key, this->Params[j].name, false);
+			if(k >= 0 && this->Index[k].param == j)
+				this->IndexErase(k);
+		}
+	}
 
-//--------------------------------------------------------------------------
-//!
-//! \brief Converts a dictionnary into a string
-//! \param    d    the dictionnary pointer to convert
-//! \return   a string representing the converted dictionnary
-//! 
-//! This function returns a string value for the specified dictionnary.
-//! Today, the dictionnary is linked to the INI file (this will change)
-//!
-//--------------------------------------------------------------------------
-string __CALL INIParser::DicoToString(const dictionnary *d)
-{
-	string s = "";
-	vector<string> p = this->GetLines();
-	this->GetLinesType();
+	// the new text replaces the old one, the views are moved if needed
+	if(delta == 0)
+	{
+		memcpy(&(this->TextFile[A]), N.data() + A, E - A);
+	}
+	else
+	{
+		const char *Old = this->TextFile.data();
+		size_t OldSize = this->TextFile.size();
+		this->TextFile.swap(Text);
+		this->Source = this->TextFile;
+		const char *New = this->TextFile.data();
 
-	if(d == NULL)
-		return s;
+		for(int i = 0; i < S; i++)
+		{
+			Rebase(this->Sections[i].key, Old, OldSize, New, A, E, delta);
+			Rebase(this->Sections[i].comment, Old, OldSize, New, A, E, delta);
+		}
+		for(unsigned int j = 0; j < this->Params.size(); j++)
+		{
+			Rebase(this->Params[j].name, Old, OldSize, New, A, E, delta);
+			Rebase(this->Params[j].value, Old, OldSize, New, A, E, delta);
+			Rebase(this->Params[j].comment, Old, OldSize, New, A, E, delta);
+		}
+		for(int h = 0; h < this->Lines.End(); h++)
+			Rebase(this->Lines[h].text, Old, OldSize, New, A, E, delta);
+	}
 
-	for(unsigned int l = 0; l < this->LinesType->size(); l++)
+	// the changed lines are parsed again
+	string_view t = this->Source.substr(0, E + delta);
+	vector<sectionview> NewSections;
+	vector<parameterview> NewParams;
+	vector<lineview> NewLines;
+	int CurrentSection = sa - 1;
+	int AttachFirst = -1;
+	int AttachLast = -1;
+	size_t pos = A;
+	scanline sl[256];
+	while(pos < t.size())
 	{
-		if(this->LinesType->at(l) == 0)
-			s += this->Comments->at(l).text + "\n";
-		else if(this->LinesType->at(l) == 1 || this->LinesType->at(l) == 2)
+		size_t nl;
+		pos = INIScan(t, pos, sl, 256, nl);
+
+		for(size_t i = 0; i < nl; i++)
 		{
-			bool WriteDone = false;
-			for(unsigned int i = 0; i < d->sections.size(); i++)
+			lineview lv;
+			sectionview s;
+			parameterview sp;
+			int kind = this->ParseLine(t, sl[i], CurrentSection >= 0, lv, s, sp);
+
+			if(kind == 1)
 			{
-				if(d->sections[i].line == l)
-				{
-					WriteDone = true;
-					s += "\n[" + d->sections[i].key + "]" + this->Comments->at(l).text + "\n";
-				}
+				NewSections.push_back(s);
+				CurrentSection = sa + NewSections.size() - 1;
+				lv.sec = CurrentSection;
 			}
-			if(!WriteDone)
+			else if(kind == 2)
 			{
-				for(unsigned int i = 0; i < d->sections.size(); i++)
-				{
-					for(unsigned int j = 0; j < d->sections[i].parameters.size(); j++)
-					{
-						if(d->sections[i].parameters[j].line == l)
-						{
-							s += d->sections[i].parameters[j].name + " = " + d->sections[i].parameters[j].value + \
-								 this->Comments->at(l).text + "\n";
-						}
-					}
-				}
+				int j = pa + NewParams.size();
+				NewParams.push_back(sp);
+				int *last = &AttachLast;
+				if(CurrentSection >= sa)
+					last = &(NewSections[CurrentSection - sa].last);
+				if(*last >= 0)
+					NewParams[*last - pa].next = j;
+				else if(CurrentSection >= sa)
+					NewSections[CurrentSection - sa].first = j;
+				else
+					AttachFirst = j;
+				*last = j;
+				lv.sec = CurrentSection;
+				lv.param = j;
 			}
+			NewLines.push_back(lv);
 		}
 	}
+	INI_COUNT(lines, NewLines.size());
 
-	return s;
-}
-
-
-//--------------------------------------------------------------------------
-//!
-//! \brief Writes a dictionnary into an INI file
-//! \param    d    the dictionnary to write
-//! \param    File a char pointer to the INI file name
-//! \return   a boolean indicating if the writing operation is a success
-//! 
-//! This function needs a pointer to the specified dictionnary and a pointer 
-//! to the file name. If the file name pointer is NULL, the dictionnary is
-//! written into the previously opened file.
-//! 
-//! This function returns a boolean to indicate the success of the writing operation
-//!
-//--------------------------------------------------------------------------
-bool __CALL INIParser::WriteINI(const dictionnary *d, const char *File)
-{
-	if(File == NULL)
-		File = this->FileName;
-
-	if(d == NULL)
-		return false;
+	// the indexes after the changed lines are shifted
+	int ds = (int)NewSections.size() - (sb - sa);
+	int dp = (int)NewParams.size() - (pb - pa);
+	if(ds != 0 || dp != 0)
+	{
+		for(int i = sb; i < S; i++)
+		{
+			if(this->Sections[i].first >= 0)
+			{
+				this->Sections[i].first += dp;
+				this->Sections[i].last += dp;
+			}
+		}
+		for(unsigned int j = pb; j < this->Params.size(); j++)
+		{
+			if(this->Params[j].next >= 0)
+				this->Params[j].next += dp;
+		}
+		for(unsigned int k = 0; k < this->Index.size(); k++)
+		{
+			keyslot &e = this->Index[k];
+			if(e.sec < sb && e.param < pb)
+				continue;
+			this->Layout -= LayoutTerm(e);
+			if(e.sec >= sb)
+				e.sec += ds;
+			if(e.param >= pb)
+				e.param += dp;
+			this->Layout += LayoutTerm(e);
+		}
+		for(int h = 0; h < this->Lines.End(); h++)
+		{
+			lineview &lv = this->Lines[h];
+			if(lv.sec >= sb)
+				lv.sec += ds;
+			if(lv.param >= pb)
+				lv.param += dp;
+		}
+	}
 
-	try
+	this->Sections.erase(this->Sections.begin() + sa, this->Sections.begin() + sb);
+	this->Sections.insert(this->Sections.begin() + sa, NewSections.begin(), NewSections.end());
+	this->Params.erase(this->Params.begin() + pa, this->Params.begin() + pb);
+	this->Params.insert(this->Params.begin() + pa, NewParams.begin(), NewParams.end());
+	if(AttachFirst >= 0)
 	{
-		ofstream f;
-		f.open(File, ios::out);
-		string s = this->DicoToString(d);
-		f.write(s.c_str(), s.size());
-		f.close();
-		return true;
+		sectionview &s = this->Sections[sa - 1];
+		if(s.last >= 0)
+			this->Params[s.last].next = AttachFirst;
+		else
+			s.first = AttachFirst;
+		s.last = AttachLast;
 	}
-	catch(...)
+
+	// the new lines replace the old ones, then the new keys are indexed
+	this->Lines.Erase(LA, LE - LA);
+	int ns = sa + NewSections.size();
+	int np = pa + NewParams.size();
+	for(unsigned int i = 0; i < NewLines.size(); i++)
 	{
-		return false;
+		const lineview &lv = NewLines[i];
+		int h = this->Lines.Insert(LA + i, lv);
+		if(lv.param >= 0)
+		{
+			parameterview &sp = this->Params[lv.param];
+			sp.handle = h;
+			string_view key = this->Sections[lv.sec].key;
+			int k = this->IndexFind(INIHashKey(key, sp.name), key, sp.name, false);
+			// a later declaration of the key wins, the lines are parsed again
+			if(k >= 0 && this->Index[k].param >= np)
+				return this->Open(File.c_str(), this->OpenFlags);
+			this->IndexInsert(lv.sec, lv.param);
+		}
+		else if(lv.sec >= 0)
+		{
+			sectionview &s = this->Sections[lv.sec];
+			s.handle = h;
+			int k = this->IndexFind(INIHashSection(s.key), s.key, "", true);
+			if(k >= 0 && this->Index[k].sec >= ns)
+				return this->Open(File.c_str(), this->OpenFlags);
+			this->IndexInsert(lv.sec, -1);
+		}
 	}
 
-}
+	this->DicoChanged = true;
+	this->Track(Known, Before);
+	if(this->AutoPublish)
+		this->Publish();
 
-//--------------------------------------------------------------------------
-//!
-//! \brief Set a boolean value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \param    value      the value to set for the specified key
-//! \return   a boolean indicating if the writing operation is a success
-//! 
-//! This function needs a pointer to the specified dictionnary and a pointer 
-//! to the specified key. if the section doesn't exists, it will be created.
-//! If the key doesn't exist (but the section does), a new key is added to 
-//! the specified section.
-//! Then, the modified dictionnary is writted to the INI file if it exists
-//! 
-//! This function returns a boolean to indicate the success of the writing operation
-//!
-//--------------------------------------------------------------------------
-bool __CALL INIParser::SetValue(const char *section, const char *key, bool value)
-{
-	if(value)
-		return this->WriteValue(section, key, "true");
-	else
-		return this->WriteValue(section, key, "false");
+	return true;
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Set an integer value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \param    value      the value to set for the specified key
-//! \return   a boolean indicating if the writing operation is a success
-//! 
-//! This function needs a pointer to the specified dictionnary and a pointer 
-//! to the specified key. if the section doesn't exists, it will be created.
-//! If the key doesn't exist (but the section does), a new key is added to 
-//! the specified section.
-//! Then, the modified dictionnary is writted to the INI file if it exists
+//! \brief Get the offset of the line of a section
+//! \param    sec    the index of the section
+//! \return   the offset of the first character of the line in the text
 //! 
-//! This function returns a boolean to indicate the success of the writing operation
+//! This function is for local using only. The name of the section must be
+//! a view into INIParser::Source.
 //!
 //--------------------------------------------------------------------------
-bool __CALL INIParser::SetValue(const char *section, const char *key, int value)
+size_t __CALL INIParser::SectionOffset(int sec)
 {
-	return this->WriteValue(section, key, this->NumToStr(value));
+	const char *t = this->Source.data();
+	size_t i = this->Sections[sec].key.data() - t;
+	while(i > 0 && t[i - 1] != '\n' && t[i - 1] != '\r')
+		i--;
+	return i;
 }
 
+#ifdef INI_STATS
 //--------------------------------------------------------------------------
 //!
-//! \brief Set a double value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \param    value      the value to set for the specified key
-//! \param    precision  the number of digits after point (default = 6)
-//! \return   a boolean indicating if the writing operation is a success
-//! 
-//! This function needs a pointer to the specified dictionnary and a pointer 
-//! to the specified key. if the section doesn't exists, it will be created.
-//! If the key doesn't exist (but the section does), a new key is added to 
-//! the specified section.
-//! Then, the modified dictionnary is writted to the INI file if it exists
-//! 
-//! This function returns a boolean to indicate the success of the writing operation
+//! \brief Get the statistics of the parser
+//! \return   the statistics counted since the parser was created (see INIStats)
+//!
+//! This function only exists when INI_STATS is defined. The statistics are
+//! kept when another file is opened.
 //!
 //--------------------------------------------------------------------------
-bool __CALL INIParser::SetValue(const char *section, const char *key, double value, int precision)
+const INIStats & __CALL INIParser::GetStats()
 {
-	return this->WriteValue(section, key, this->NumToStr(value, precision));
+	return this->Stats;
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Set a string value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \param    value      the value to set for the specified key
-//! \return   a boolean indicating if the writing operation is a success
-//! 
-//! This function needs a pointer to the specified dictionnary and a pointer 
-//! to the specified key. if the section doesn't exists, it will be created.
-//! If the key doesn't exist (but the section does), a new key is added to 
-//! the specified section.
-//! Then, the modified dictionnary is writted to the INI file if it exists
-//! 
-//! This function returns a boolean to indicate the success of the writing operation
+//! \brief Reset the statistics of the parser
+//!
+//! This function only exists when INI_STATS is defined.
 //!
 //--------------------------------------------------------------------------
-bool __CALL INIParser::SetValue(const char *section, const char *key, string value)
+void __CALL INIParser::ResetStats()
 {
-	return this->WriteValue(section, key, value);
+	this->Stats = INIStats();
 }
 
 //--------------------------------------------------------------------------
 //!
-//! \brief Set a converted string value
-//! \param    section    a char pointer to the section name
-//! \param    key        a char pointer to the parameter name
-//! \param    value      the value to set for the specified key
+//! \brief Writes the statistics of the parser into a stream
+//! \param    Out  the stream receiving the statistics
 //! \return   a boolean indicating if the writing operation is a success
-//! 
-//! This function needs a pointer to the specified dictionnary and a pointer 
-//! to the specified key. if the section doesn't exists, it will be created.
-//! If the key doesn't exist (but the section does), a new key is added to 
-//! the specified section.
-//! Then, the modified dictionnary is writted to the INI file if it exists
-//! 
-//! This function returns a boolean to indicate the success of the writing operation
+//!
+//! This function only exists when INI_STATS is defined. The statistics are
+//! written in the text format of Prometheus, every sample is labelled with
+//! the name of the INI file. The lines, sections and parameters are the
+//! ones of the current index.
 //!
 //--------------------------------------------------------------------------
-bool __CALL INIParser::WriteValue(const char *section, const char *parameter, string value)
+bool __CALL INIParser::WriteStats(ostream &Out)
 {
-	bool success = false;
+	static const char *Phases[INI_PHASE_COUNT] =
+		{"load", "parse", "reload", "sections_name", "section", "dictionnary", "write"};
+	const INIStats &s = this->Stats;
 
-	if(this->dico->sections.size() == 0)
-		*(this->dico) = this->GetDictionnary();
-
-	bool sExists = false;
-	bool pExists = false;
-	for(unsigned int i = 0; i < this->dico->sections.size(); i++)
+	string Label = "file=\"";
+	for(size_t i = 0; i < this->Path.size(); i++)
 	{
-		if(this->dico->sections[i].key == string(section))
-		{
-			sExists = true;
-			for(unsigned int j = 0; j < this->dico->sections[i].parameters.size(); j++)
-			{
-				cout << "Ancienne ligne : " << this->dico->sections[i].parameters[j].line << endl;
-				if(this->dico->sections[i].parameters[j].name == string(parameter))
-				{
-					pExists = true;
-					this->dico->sections[i].parameters[j].value = value;
-				}
-			}
-			if(!pExists)
-			{
-				cout << endl;
-				struct parameter p;
-				struct comment c;
-				vector<int>::iterator LIt = this->LinesType->begin();
-				vector<comment>::iterator CIt = this->Comments->begin();
-				c.text = "";
-				p.name = string(parameter);
-				p.value = value;
-				p.line = this->dico->sections[i].parameters[this->dico->sections[i].parameters.size() - 1].line + 1;
-				cout << "Nouvelle ligne : " << p.line << endl;
-				c.line = p.line;
-				this->ChangeLine(p.line);
-				(this->EndLine)++;
-				this->LinesType->insert(this->LinesType->begin() + p.line, 1);
-
-				this->dico->sections[i].parameters.push_back(p);
-			}
-		}
+		char c = this->Path[i];
+		if(c == '\\' || c == '"')
+			Label += '\\';
+		if(c == '\n')
+			Label += "\\n";
+		else
+			Label += c;
 	}
+	Label += '"';
 
-	if(!sExists)
-	{
-		struct section s;
-		struct parameter p;
-		struct comment c;
-		c.text = "";
-		s.key = string(section);
-		s.line = this->EndLine;
-		c.line = this->EndLine;
-		(this->EndLine)++;
-		this->LinesType->push_back(1);
-		this->Comments->push_back(c);
-
-		p.name = string(parameter);
-		p.value = value;
-		p.line = this->EndLine;
-		c.line = this->EndLine;
-		(this->EndLine)++;
-		this->LinesType->push_back(1);
-		this->Comments->push_back(c);
+	MetricHeader(Out, "iniparser_phase_calls_total", "counter", "Number of runs of every phase of the parser.");
+	for(int i = 0; i < INI_PHASE_COUNT; i++)
+		Out << "iniparser_phase_calls_total{" << Label << ",phase=\"" << Phases[i] << "\"} " << s.calls[i] << '\n';
 
-		s.parameters.push_back(p);
-		this->dico->sections.push_back(s);
+	MetricHeader(Out, "iniparser_phase_seconds_total", "counter", "Time spent in every phase of the parser.");
+	for(int i = 0; i < INI_PHASE_COUNT; i++)
+	{
+		char Seconds[32];
+		snprintf(Seconds, sizeof(Seconds), "%.9f", s.time[i] / 1e9);
+		Out << "iniparser_phase_seconds_total{" << Label << ",phase=\"" << Phases[i] << "\"} " << Seconds << '\n';
 	}
 
-	if(this->FileName != NULL)
-		success = this->WriteINI(this->dico, NULL);
-
-	return success;
+	MetricHeader(Out, "iniparser_read_bytes_total", "counter", "Bytes read from the INI file.");
+	Out << "iniparser_read_bytes_total{" << Label << "} " << s.bytesread << '\n';
+	MetricHeader(Out, "iniparser_parsed_lines_total", "counter", "Lines parsed.");
+	Out << "iniparser_parsed_lines_total{" << Label << "} " << s.lines << '\n';
+
+	MetricHeader(Out, "iniparser_lines", "gauge", "Lines of the index, without the empty lines.");
+	Out << "iniparser_lines{" << Label << "} " << this->Lines.Count() << '\n';
+	MetricHeader(Out, "iniparser_sections", "gauge", "Sections of the index.");
+	Out << "iniparser_sections{" << Label << "} " << this->Sections.size() << '\n';
+	MetricHeader(Out, "iniparser_parameters", "gauge", "Parameters of the index.");
+	Out << "iniparser_parameters{" << Label << "} " << this->Params.size() << '\n';
+
+	MetricHeader(Out, "iniparser_lookups_total", "counter", "Lookups of a section or a parameter by name.");
+	Out << "iniparser_lookups_total{" << Label << ",result=\"hit\"} " << s.hits << '\n';
+	Out << "iniparser_lookups_total{" << Label << ",result=\"miss\"} " << s.misses << '\n';
+	MetricHeader(Out, "iniparser_key_reads_total", "counter", "Reads with a resolved key.");
+	Out << "iniparser_key_reads_total{" << Label << "} " << s.keyreads << '\n';
+	MetricHeader(Out, "iniparser_key_resolves_total", "counter", "Resolutions of a key.");
+	Out << "iniparser_key_resolves_total{" << Label << "} " << s.keyresolves << '\n';
+
+	MetricHeader(Out, "iniparser_cache_total", "counter", "Reads of the converted values and of the dictionnary.");
+	Out << "iniparser_cache_total{" << Label << ",cache=\"value\",result=\"hit\"} " << s.valuehits << '\n';
+	Out << "iniparser_cache_total{" << Label << ",cache=\"value\",result=\"miss\"} " << s.valuemisses << '\n';
+	Out << "iniparser_cache_total{" << Label << ",cache=\"dictionnary\",result=\"hit\"} " << s.dicohits << '\n';
+	Out << "iniparser_cache_total{" << Label << ",cache=\"dictionnary\",result=\"miss\"} " << s.dicomisses << '\n';
+
+	MetricHeader(Out, "iniparser_rewrites_total", "counter", "Files written.");
+	Out << "iniparser_rewrites_total{" << Label << "} " << s.rewrites << '\n';
+	MetricHeader(Out, "iniparser_written_bytes_total", "counter", "Bytes written into the files.");
+	Out << "iniparser_written_bytes_total{" << Label << "} " << s.byteswritten << '\n';
+
+	return !Out.fail();
 }
+#endif
+
+//--------------------------------------------------------------------------
+//                              INIUPDATE METHODS
+//--------------------------------------------------------------------------
 
-// --------------------------------------------------------------------------
-// Change the lines of sections, parameters and comments when a new parameter
-// has been added to a dictionnary. Only line greater than the 'NewLine' are
-// modified
-void __CALL INIParser::ChangeLine(unsigned int NewLine)
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INIUpdate class
+//! \param    Parser   the parser to update
+//! \return   an instance of the class
+//! 
+//! This function begins an update of the parser (see INIParser::BeginUpdate())
+//!
+//--------------------------------------------------------------------------
+__CALL INIUpdate::INIUpdate(INIParser *Parser)
 {
-	for(unsigned int i = 0; i < this->dico->sections.size(); i++)
-	{
-		if(this->dico->sections[i].line >= NewLine)
-		{
-			(this->dico->sections[i].line)++;
-		}
+	this->Parser = Parser;
+	this->Done = false;
+	this->Parser->BeginUpdate();
+}
 
-		for(unsigned int j = 0; j < this->dico->sections[i].parameters.size(); j++)
-		{
-			if(this->dico->sections[i].parameters[j].line >= NewLine)
-			{
-				(this->dico->sections[i].parameters[j].line)++;
-			}
-		}
-	}
+//-------------------------------------------------------------------------
+//!
+//! \brief    Destructor of the INIUpdate class
+//! 
+//! This function ends the update if Commit() has not been called.
+//!
+//--------------------------------------------------------------------------
+__CALL INIUpdate::~INIUpdate()
+{
+	this->Commit();
+}
 
-	for(unsigned int i = 0; i < this->Comments->size(); i++)
-	{
-		if(this->Comments->at(i).line >= NewLine)
-			(this->Comments->at(i).line)++;
-	}
+//-------------------------------------------------------------------------
+//!
+//! \brief    Commit the update
+//! \return   a boolean indicating if the writing operation is a success
+//! 
+//! This function ends the update (see INIParser::EndUpdate()). It can be
+//! called once, the next calls do nothing and return true.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIUpdate::Commit()
+{
+	if(this->Done)
+		return true;
 
+	this->Done = true;
+	return this->Parser->EndUpdate();
 }
@@ -14,12 +14,25 @@
 //--------------------------------------------------------------------------
 //                            PRE-COMPILER DECLARATIONS
 //--------------------------------------------------------------------------
+#ifndef INIParserH
+#define INIParserH
+
 #include <string.h>
+#include <cstddef>
+#include <iosfwd>
+#include <iterator>
+#include <string>
+#include <string_view>
 #include <vector>
+#include <forward_list>
+#include <memory_resource>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include <functional>
 
-#ifndef INIParserH
-#define INIParserH
-#endif
+#include "INILineTable.h"
+#include "INIScanner.h"
 
 // machine Linux
 #if __linux__
@@ -80,10 +93,470 @@ struct comment
 	int line;
 };
 
+//! \brief status of a value converted by INIParser::TryGetInteger(), TryGetDouble() or TryGetBoolean()
+enum INIValueStatus
+{
+	//! \brief the whole value is converted
+	INI_VALUE_OK = 0,
+	//! \brief the section or the parameter does not exist
+	INI_VALUE_MISSING = 1,
+	//! \brief the value is not a valid integer, double or boolean
+	INI_VALUE_MALFORMED = 2,
+	//! \brief the value has not been converted yet (only in parameterview::status)
+	INI_VALUE_UNKNOWN = 3
+};
+
+//! \brief structure for a parameter of the parser index
+//!
+//! The strings are views into the text of the INI file (or into the
+//! values stored by the parser when a parameter has been modified).
+//! The value is converted into an integer, a double or a boolean the
+//! first time it is read with this type, then the converted value is kept.
+struct parameterview
+{
+	//! \brief the name of the parameter
+	std::string_view name;
+	//! \brief the value of the parameter
+	std::string_view value;
+	//! \brief the comment of the parameter
+	std::string_view comment;
+	//! \brief the handle of the line of the parameter (see INIParser::GetLineNumber())
+	int handle;
+	//! \brief the index of the next parameter of the same section (-1 for the last one)
+	int next;
+	//! \brief the value converted into an integer
+	long long integer;
+	//! \brief the value converted into a double
+	double real;
+	//! \brief the value converted into a boolean
+	bool boolean;
+	//! \brief the status of the conversions into integer, double and boolean (INIValueStatus)
+	unsigned char status[3];
+};
+
+//! \brief structure for a section of the parser index
+struct sectionview
+{
+	//! \brief the name of the section
+	std::string_view key;
+	//! \brief the comment of the section
+	std::string_view comment;
+	//! \brief the handle of the line of the section (see INIParser::GetLineNumber())
+	int handle;
+	//! \brief the index of the first parameter of the section (-1 if the section is empty)
+	int first;
+	//! \brief the index of the last parameter of the section (-1 if the section is empty)
+	int last;
+};
+
+//! \brief structure for an entry of the key index
+struct keyslot
+{
+	//! \brief the hash of the section name (and of the parameter name)
+	unsigned long long hash;
+	//! \brief the index of the section (-1 for an empty slot)
+	int sec;
+	//! \brief the index of the parameter (-1 for a section)
+	int param;
+};
+
+//! \brief structure for a value modified in the text of the INI file
+//!
+//! The file is patched: the text read from the file is written again, with
+//! the new values in place of the old ones (see INIParser::SetValue()).
+struct textpatch
+{
+	//! \brief the offset of the old value in the text
+	std::size_t offset;
+	//! \brief the size of the old value
+	std::size_t size;
+	//! \brief the size of the value in the file
+	std::size_t written;
+	//! \brief the index of the parameter
+	int param;
+	//! \brief true if the value has changed since the file was written
+	bool dirty;
+};
+
+//! \brief structure identifying the content of a file without reading it
+struct fileversion
+{
+	//! \brief the device of the file
+	unsigned long long device;
+	//! \brief the inode of the file
+	unsigned long long inode;
+	//! \brief the size of the file in bytes
+	unsigned long long size;
+	//! \brief the modification time of the file in nanoseconds
+	long long time;
+};
+
+//! \brief flags for opening an INI file
+enum INIOpenFlags
+{
+	//! \brief the file is read into INIParser::TextFile
+	INI_DEFAULT = 0,
+	//! \brief the file is mapped read-only in memory instead of being read
+	INI_MAPPED = 1,
+	//! \brief the text and the index of the file are allocated in an arena
+	INI_ARENA = 2,
+	//! \brief a snapshot is published after opening and after every modification
+	INI_SNAPSHOT = 4,
+	//! \brief a large file is split at its sections and parsed by several threads
+	INI_PARALLEL = 8,
+	//! \brief the names are kept in the pool of the process, and the text of the file is not kept (see INIInternPool)
+	INI_INTERN = 16,
+	//! \brief the values of the same size are written in the file itself, which is not atomic
+	INI_INPLACE = 32
+};
+
+#ifdef INI_STATS
+//! \brief phases timed by the statistics of a parser (see INIStats)
+enum INIStatsPhase
+{
+	//! \brief reading or mapping the INI file (Open(), Refresh())
+	INI_PHASE_LOAD = 0,
+	//! \brief building the index of the whole file (Open())
+	INI_PHASE_PARSE = 1,
+	//! \brief parsing again the changed sections (Refresh())
+	INI_PHASE_RELOAD = 2,
+	//! \brief copying the sections name (GetSectionsName())
+	INI_PHASE_SECTIONS = 3,
+	//! \brief copying a section (GetSection())
+	INI_PHASE_SECTION = 4,
+	//! \brief building the dictionnary (GetDictionnary())
+	INI_PHASE_DICTIONNARY = 5,
+	//! \brief writing a file (WriteINI(), SetValue(), EndUpdate(), Compile())
+	INI_PHASE_WRITE = 6,
+	//! \brief the number of phases
+	INI_PHASE_COUNT = 7
+};
+
+//! \brief structure for the statistics of a parser (see INIParser::GetStats())
+//!
+//! The statistics only exist when INI_STATS is defined, for the library and
+//! for the programs using it. Otherwise, the parser counts nothing at all.
+//! A reload which parses the whole file again (see INIParser::Refresh())
+//! is also counted as a load and a parse.
+struct INIStats
+{
+	//! \brief the number of runs of every phase (see INIStatsPhase)
+	unsigned long long calls[INI_PHASE_COUNT];
+	//! \brief the time spent in every phase, in nanoseconds
+	unsigned long long time[INI_PHASE_COUNT];
+	//! \brief the number of bytes read from the INI file
+	unsigned long long bytesread;
+	//! \brief the number of lines parsed
+	unsigned long long lines;
+	//! \brief the number of lookups by name which found the section or the parameter
+	unsigned long long hits;
+	//! \brief the number of lookups by name which did not find it
+	unsigned long long misses;
+	//! \brief the number of reads with a resolved key (see INIKey)
+	unsigned long long keyreads;
+	//! \brief the number of key resolutions (see INIParser::Resolve())
+	unsigned long long keyresolves;
+	//! \brief the number of typed reads served by the converted value
+	unsigned long long valuehits;
+	//! \brief the number of typed reads which converted the value
+	unsigned long long valuemisses;
+	//! \brief the number of times the dictionnary has been reused
+	unsigned long long dicohits;
+	//! \brief the number of times the dictionnary has been built
+	unsigned long long dicomisses;
+	//! \brief the number of files written
+	unsigned long long rewrites;
+	//! \brief the number of bytes written into the files
+	unsigned long long byteswritten;
+};
+#endif
+
+//-------------------------------------------------------------------------
+//!
+//! \class INIMemory
+//! \brief Memory resource of the INIParser class.
+//!
+//! The allocations of the parser are forwarded either to the heap or to a
+//! monotonic arena, which allocates in a few contiguous blocks and is
+//! released at once when the INI file is closed.
+//!
+//--------------------------------------------------------------------------
+class INIMemory : public std::pmr::memory_resource
+{
+	public:
+		std::pmr::monotonic_buffer_resource Arena;
+		bool UseArena;
+
+		INIMemory() : UseArena(false) {}
+
+	private:
+		void *do_allocate(std::size_t bytes, std::size_t alignment) override
+		{
+			if(this->UseArena)
+				return this->Arena.allocate(bytes, alignment);
+			return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+		}
+
+		void do_deallocate(void *p, std::size_t bytes, std::size_t alignment) override
+		{
+			if(!this->UseArena)
+				std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+		}
+
+		bool do_is_equal(const std::pmr::memory_resource &other) const noexcept override
+		{
+			return this == &other;
+		}
+};
+
+//--------------------------------------------------------------------------
+//                              HASH FUNCTIONS
+//--------------------------------------------------------------------------
+
+//! \brief Hash a string (FNV-1a), h is the hash to continue from
+constexpr unsigned long long INIHash(std::string_view s, unsigned long long h = 14695981039346656037ULL)
+{
+	for(std::size_t i = 0; i < s.size(); i++)
+		h = (h ^ (unsigned char)(s[i])) * 1099511628211ULL;
+	return h;
+}
+
+//! \brief Hash a section name
+constexpr unsigned long long INIHashSection(std::string_view section)
+{
+	return INIHash(std::string_view("\0", 1), INIHash(section));
+}
+
+//! \brief Hash a section name and a parameter name
+constexpr unsigned long long INIHashKey(std::string_view section, std::string_view key)
+{
+	return INIHash(key, INIHash(std::string_view("\1", 1), INIHash(section)));
+}
+
+//! \brief Compare two names, at once if they are the same view (see INIInternPool)
+inline bool INISameName(std::string_view a, std::string_view b)
+{
+	return a.size() == b.size() && (a.data() == b.data() || a.size() == 0 || memcmp(a.data(), b.data(), a.size()) == 0);
+}
+
+//--------------------------------------------------------------------------
+//                              KEY HANDLES
+//--------------------------------------------------------------------------
+
+//! \brief structure for a key resolved once by INIParser::Resolve()
+//!
+//! A resolved key knows the index of its parameter, so reading it is an
+//! indexed load without hashing or comparing the names. The key stays valid
+//! while the key index keeps the same layout (the same sections and
+//! parameters at the same places), even if the values change or the file is
+//! opened again. Otherwise it is resolved again by the next read.
+//! The names are not copied: they must live as long as the key. Declared
+//! static with string literals, the hash is computed at compile time:<br>
+//! `static INIKey Timeout("net", "timeout"); parser->GetInteger(Timeout);`
+struct INIKey
+{
+	//! \brief the name of the section
+	std::string_view section;
+	//! \brief the name of the parameter
+	std::string_view key;
+	//! \brief the hash of the section name and of the parameter name
+	unsigned long long hash;
+	//! \brief the layout of the key index when the key was resolved
+	unsigned long long layout;
+	//! \brief the index of the parameter (-1 if it does not exist)
+	int param;
+
+	constexpr INIKey(std::string_view section = std::string_view(), std::string_view key = std::string_view()) :
+		section(section), key(key), hash(INIHashKey(section, key)), layout(0), param(-1) {}
+};
+
+//--------------------------------------------------------------------------
+//                              BATCHED QUERIES
+//--------------------------------------------------------------------------
+
+//! \brief type of the value of an INIQuery
+enum INIValueType
+{
+	//! \brief a std::string (copied)
+	INI_TYPE_STRING = 0,
+	//! \brief a std::string_view into the index (see INIParser::GetStringView())
+	INI_TYPE_VIEW = 1,
+	//! \brief an int
+	INI_TYPE_INT = 2,
+	//! \brief a long long
+	INI_TYPE_LONG = 3,
+	//! \brief a double
+	INI_TYPE_DOUBLE = 4,
+	//! \brief a bool
+	INI_TYPE_BOOLEAN = 5
+};
+
+//! \brief structure for a value read by INIParser::Query()
+//!
+//! A query reads a key into a variable of the caller, whose type gives the
+//! type of the value. The key is resolved by the first query, so a table of
+//! queries kept by the program is read by indexed loads the next times
+//! (see INIKey). The names are not copied.<br>
+//! `INIQuery q[] = {{"net", "port", &s.port}, {"net", "host", &s.host}}; parser->Query(q, 2);`
+struct INIQuery
+{
+	//! \brief the key to read
+	INIKey key;
+	//! \brief the type of the variable
+	INIValueType type;
+	//! \brief the variable receiving the value
+	void *value;
+	//! \brief the status of the last query (INI_VALUE_UNKNOWN before the first one)
+	INIValueStatus status;
+
+	INIQuery(std::string_view section, std::string_view key, std::string *value) :
+		key(section, key), type(INI_TYPE_STRING), value(value), status(INI_VALUE_UNKNOWN) {}
+	INIQuery(std::string_view section, std::string_view key, std::string_view *value) :
+		key(section, key), type(INI_TYPE_VIEW), value(value), status(INI_VALUE_UNKNOWN) {}
+	INIQuery(std::string_view section, std::string_view key, int *value) :
+		key(section, key), type(INI_TYPE_INT), value(value), status(INI_VALUE_UNKNOWN) {}
+	INIQuery(std::string_view section, std::string_view key, long long *value) :
+		key(section, key), type(INI_TYPE_LONG), value(value), status(INI_VALUE_UNKNOWN) {}
+	INIQuery(std::string_view section, std::string_view key, double *value) :
+		key(section, key), type(INI_TYPE_DOUBLE), value(value), status(INI_VALUE_UNKNOWN) {}
+	INIQuery(std::string_view section, std::string_view key, bool *value) :
+		key(section, key), type(INI_TYPE_BOOLEAN), value(value), status(INI_VALUE_UNKNOWN) {}
+};
+
+//--------------------------------------------------------------------------
+//                              VIEW RANGES
+//--------------------------------------------------------------------------
+
+//! \brief range of the sections of a parser (see INIParser::GetSections())
+//!
+//! The range refers to the index of the parser, in the order of the file:
+//! it is valid until the INI file is modified or reopened, and walking it
+//! does not allocate anything.
+struct INISectionRange
+{
+	//! \brief the first section
+	const sectionview *first;
+	//! \brief the end of the sections
+	const sectionview *last;
+
+	const sectionview *begin() const { return this->first; }
+	const sectionview *end() const { return this->last; }
+	std::size_t size() const { return this->last - this->first; }
+	bool empty() const { return this->first == this->last; }
+	const sectionview &operator[](std::size_t i) const { return this->first[i]; }
+};
+
+//! \brief range of the parameters of a section (see INIParser::GetParameters())
+//!
+//! The parameters of a section are linked by parameterview::next, in the
+//! order of the file. The range is valid until the INI file is modified or
+//! reopened, and walking it does not allocate anything.
+struct INIParameterRange
+{
+	//! \brief iterator on the parameters of a section
+	class iterator
+	{
+		private:
+			const parameterview *Params;
+			int Param;
+
+		public:
+			typedef std::forward_iterator_tag iterator_category;
+			typedef parameterview value_type;
+			typedef std::ptrdiff_t difference_type;
+			typedef const parameterview *pointer;
+			typedef const parameterview &reference;
+
+			iterator(const parameterview *Params = NULL, int Param = -1) : Params(Params), Param(Param) {}
+			reference operator*() const { return this->Params[this->Param]; }
+			pointer operator->() const { return &(this->Params[this->Param]); }
+			iterator &operator++() { this->Param = this->Params[this->Param].next; return *this; }
+			iterator operator++(int) { iterator i = *this; ++(*this); return i; }
+			bool operator==(const iterator &i) const { return this->Param == i.Param; }
+			bool operator!=(const iterator &i) const { return this->Param != i.Param; }
+	};
+
+	//! \brief the parameters of the parser
+	const parameterview *params;
+	//! \brief the index of the first parameter of the section (-1 if it is empty)
+	int first;
+
+	iterator begin() const { return iterator(this->params, this->first); }
+	iterator end() const { return iterator(this->params, -1); }
+	bool empty() const { return this->first < 0; }
+};
+
+//--------------------------------------------------------------------------
+//                              SORTED KEYS
+//--------------------------------------------------------------------------
+
+//! \brief structure for an entry of the sorted key index
+struct keyentry
+{
+	//! \brief the index of the section
+	int sec;
+	//! \brief the index of the parameter
+	int param;
+};
+
+//! \brief cursor on the keys found by INIParser::FindPrefix() or INIParser::FindRange()
+//!
+//! The keys are walked in the order of their names, without copying
+//! anything: the cursor refers to the index of the parser, so it is valid
+//! until the INI file is modified or reopened.<br>
+//! `for(INIKeyCursor c = parser->FindPrefix("db", "replica."); !c.done(); c.next()) c.parameter().value;`
+struct INIKeyCursor
+{
+	//! \brief the current key
+	const keyentry *pos;
+	//! \brief the end of the keys
+	const keyentry *last;
+	//! \brief the sections of the parser
+	const sectionview *sections;
+	//! \brief the parameters of the parser
+	const parameterview *params;
+
+	bool done() const { return this->pos == this->last; }
+	void next() { this->pos++; }
+	std::size_t size() const { return this->last - this->pos; }
+	const sectionview &section() const { return this->sections[this->pos->sec]; }
+	const parameterview &parameter() const { return this->params[this->pos->param]; }
+};
+
+//--------------------------------------------------------------------------
+//                              CONVERSION FUNCTIONS
+//--------------------------------------------------------------------------
+
+INIValueStatus INIToInteger(std::string_view value, long long &result);
+INIValueStatus INIToDouble(std::string_view value, double &result);
+INIValueStatus INIToBoolean(std::string_view value, bool &result);
+
 //--------------------------------------------------------------------------
 //                              INIPARSER CLASS
 //--------------------------------------------------------------------------
 
+class INISnapshot;
+class INIOpenTask;
+
+//! \brief structure for a snapshot published by a parser (see INIParser::Publish())
+//!
+//! A parser has two slots, used in turn by the versions it publishes. A
+//! reader copies the snapshot of a slot while it is counted in its readers,
+//! and only if the version of the slot is the one it expects. The slot is
+//! replaced only when no reader is counted, so the readers never wait.
+struct publishslot
+{
+	//! \brief the version of the snapshot (0 while it is replaced)
+	std::atomic<unsigned long> version;
+	//! \brief the number of readers copying the snapshot
+	std::atomic<unsigned int> readers;
+	//! \brief the snapshot
+	std::shared_ptr<const INISnapshot> snapshot;
+};
+
+//! \brief executor running the background work of a parser (see INIParser::OpenAsync())
+typedef std::function<void(std::function<void()>)> INIExecutor;
+
 //-------------------------------------------------------------------------
 //!
 //! \class INIParser
@@ -96,44 +569,175 @@ struct comment
 class INIParser
 {
 	private:
-		std::vector<unsigned int> *KeysLines;
-		std::vector<std::string> *Keys;
-		std::vector<comment> *Comments;
-		std::vector<int> *LinesType;
-		dictionnary *dico;
-		unsigned int FileEndLine;
-		unsigned int EndLine;
-
-		std::string __CALL StrTrim(std::string strinit, int mode=-1);
-		std::string __CALL StrLower(std::string strinit);
+		INIMemory Memory;
+		std::pmr::vector<sectionview> Sections;
+		std::pmr::vector<parameterview> Params;
+		INILineTable Lines;
+		std::pmr::vector<keyslot> Index;
+		unsigned int IndexCount;
+		unsigned long long Layout;
+		std::pmr::forward_list<std::pmr::string> Strings;
+		std::vector<textpatch> Patches;
+		fileversion Written;
+		bool Patchable;
+		std::pmr::vector<keyentry> KeyOrder;
+		std::pmr::vector<keyentry> NameOrder;
+		unsigned long long OrderLayout;
+		bool OrderBuilt;
+		std::string_view Source;
+		void *Mapping;
+		std::size_t MappingSize;
+		std::string Path;
+		dictionnary dico;
+		bool DicoChanged;
+		unsigned int UpdateCount;
+		bool Modified;
+		bool AutoPublish;
+		int OpenFlags;
+		bool Pristine;
+		bool Duplicates;
+		bool Interned;
+		std::size_t TextSize;
+		unsigned long long TextHash;
+		int WatchHandle;
+		std::string WatchName;
+		publishslot Published[2];
+		std::atomic<unsigned long> Version;
+		const std::atomic<bool> *Cancelled;
+		std::shared_ptr<INIOpenTask> Pending;
+#ifdef INI_STATS
+		mutable INIStats Stats;
+#endif
+
+		static std::string_view __CALL StrTrim(std::string_view strinit, int mode=-1);
 		std::string __CALL NumToStr(int value);
 		std::string __CALL NumToStr(double value, int precision=6);
-		std::vector<std::string> __CALL GetLines();
-		void __CALL GetLinesType();
-		std::string __CALL DicoToString(const dictionnary *d);
+		std::string_view __CALL StrStore(std::string_view value);
+		std::string_view __CALL StrName(std::string_view name);
+		bool __CALL Load(const char *File, int Flags);
+		bool __CALL ReadText(const char *File, std::string &Text);
+		void __CALL Unmap();
+		void __CALL Release(int Flags);
+		void __CALL Parse();
+		void __CALL ParallelParse();
+		void __CALL Compact();
+		static int __CALL ParseLine(std::string_view t, const scanline &L, bool InSection, lineview &lv, sectionview &s, parameterview &p);
+		bool __CALL Reload();
+		std::size_t __CALL SectionOffset(int sec);
+		void __CALL IndexInsert(int sec, int param);
+		void __CALL IndexInsert(int sec, int param, unsigned long long hash);
+		void __CALL IndexErase(int k);
+		int __CALL IndexFind(unsigned long long hash, std::string_view section, std::string_view key, bool IsSection) const;
+		static void __CALL Uncache(parameterview &p);
+		int __CALL KeyParam(INIKey &k);
+		parameterview * __CALL Convert(int param, int type);
+		parameterview * __CALL Convert(const char *section, const char *key, int type);
+		void __CALL BuildOrder();
+		INIKeyCursor __CALL OrderRange(bool BySection, std::string_view section, std::string_view from, std::string_view to, bool IsPrefix);
+		section __CALL MakeSection(const sectionview &s);
+		void __CALL Materialize();
+		void __CALL Serialize(const dictionnary *d, std::ostream &Out);
+		void __CALL Splice(std::ostream &Out);
+		void __CALL Track(bool Known, const fileversion &Before);
+		bool __CALL PatchFile(const char *File);
+		bool __CALL WriteFile(const char *File, const dictionnary *d, const INISnapshot *Image=NULL);
 		bool __CALL WriteValue(const char *section, const char *parameter, std::string value);
-		void __CALL ChangeLine(unsigned int NewLine);
 
 	public:
 		const char *FileName;
 		std::string TextFile;
 
-		__CALL INIParser(const char* File=NULL);
+		__CALL INIParser(const char* File=NULL, int Flags=INI_DEFAULT);
+		INIParser(const INIParser &) = delete;
+		INIParser &operator=(const INIParser &) = delete;
 		__CALL ~INIParser();
-		bool __CALL Open(const char* File);
+		bool __CALL Open(const char* File, int Flags=INI_DEFAULT);
+		INIOpenTask __CALL OpenAsync(const char* File, int Flags=INI_DEFAULT, INIExecutor Executor=INIExecutor());
 
-		std::vector<std::string> __CALL GetSectionsName();
-		int __CALL GetSectionNumber();
+		std::vector<std::string> __CALL GetSectionsName() const;
+		int __CALL GetSectionNumber() const;
 		section __CALL GetSection(const char *SectionName);
 		dictionnary __CALL GetDictionnary();
+		const sectionview * __CALL Find(std::string_view section) const;
+		const parameterview * __CALL Find(std::string_view section, std::string_view key) const;
+		int __CALL GetLineNumber(int handle);
 		bool __CALL GetBoolean(const char *section, const char *key);
 		std::string __CALL GetString(const char *section, const char *key);
 		int __CALL GetInteger(const char *section, const char *key);
 		double __CALL GetDouble(const char *section, const char *key);
+		INIValueStatus __CALL TryGetBoolean(const char *section, const char *key, bool &value);
+		INIValueStatus __CALL TryGetInteger(const char *section, const char *key, long long &value);
+		INIValueStatus __CALL TryGetDouble(const char *section, const char *key, double &value);
+		INIKey __CALL Resolve(const char *section, const char *key);
+		bool __CALL Resolve(INIKey &k);
+		const parameterview * __CALL Find(INIKey &k);
+		bool __CALL GetBoolean(INIKey &k);
+		std::string __CALL GetString(INIKey &k);
+		int __CALL GetInteger(INIKey &k);
+		double __CALL GetDouble(INIKey &k);
+		std::string_view __CALL GetStringView(std::string_view section, std::string_view key) const;
+		std::string_view __CALL GetStringView(INIKey &k);
+		INISectionRange __CALL GetSections() const;
+		INIParameterRange __CALL GetParameters(const sectionview &s) const;
+		INIParameterRange __CALL GetParameters(std::string_view section) const;
+		std::size_t __CALL Query(INIQuery *Queries, std::size_t Count);
+		INIKeyCursor __CALL FindPrefix(std::string_view section, std::string_view prefix);
+		INIKeyCursor __CALL FindRange(std::string_view section, std::string_view from, std::string_view to);
+		INIKeyCursor __CALL FindAllPrefix(std::string_view prefix);
+		INIKeyCursor __CALL FindAllRange(std::string_view from, std::string_view to);
 
 		bool __CALL WriteINI(const dictionnary *d, const char *File=NULL);
+		bool __CALL WriteINI(std::ostream &Out);
+		std::size_t __CALL WriteINI(char *Buffer, std::size_t Size);
+		bool __CALL Compile(const char *File);
 		bool __CALL SetValue(const char *section, const char *key, bool value);
 		bool __CALL SetValue(const char *section, const char *key, int value);
 		bool __CALL SetValue(const char *section, const char *key, double value, int precision=6);
 		bool __CALL SetValue(const char *section, const char *key, std::string value);
+		void __CALL BeginUpdate();
+		bool __CALL EndUpdate();
+
+		void __CALL Publish();
+		std::shared_ptr<const INISnapshot> __CALL Snapshot();
+		unsigned long __CALL GetVersion();
+
+		bool __CALL Watch();
+		void __CALL Unwatch();
+		int __CALL GetWatchHandle();
+		bool __CALL Refresh();
+
+#ifdef INI_STATS
+		const INIStats & __CALL GetStats();
+		void __CALL ResetStats();
+		bool __CALL WriteStats(std::ostream &Out);
+#endif
+
+		friend class INISnapshot;
+		friend class INIOverlay;
+		friend class INIStreamParser;
+};
+
+//-------------------------------------------------------------------------
+//!
+//! \class INIUpdate
+//! \brief INIUpdate class.
+//!
+//! This class groups the modifications of an INI file: the file is written
+//! once, by Commit() or when the instance is destroyed.
+//!
+//--------------------------------------------------------------------------
+class INIUpdate
+{
+	private:
+		INIParser *Parser;
+		bool Done;
+
+	public:
+		__CALL INIUpdate(INIParser *Parser);
+		INIUpdate(const INIUpdate &) = delete;
+		INIUpdate &operator=(const INIUpdate &) = delete;
+		__CALL ~INIUpdate();
+		bool __CALL Commit();
 };
+
+#endif
@@ -0,0 +1,303 @@
+//--------------------------------------------------------------------------
+//                                INISCANNER.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INIScanner.cpp
+//! \brief Functions for scanning the structure of INI text
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define INI_SCANNER_X86 1
+#include <immintrin.h>
+#endif
+
+#pragma hdrstop
+
+#include "INIScanner.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              LOCAL FUNCTIONS
+//--------------------------------------------------------------------------
+
+namespace
+{
+
+const size_t npos = string_view::npos;
+
+//! \brief structure for the state of the line being scanned
+struct scanstate
+{
+	//! \brief the position of the first character of the line
+	size_t start;
+	//! \brief the position of the first '#' or ';' of the line
+	size_t comment;
+	//! \brief the position of the first '=' of the line before the comment
+	size_t equal;
+};
+
+inline bool IsBlank(char c)
+{
+	return c == ' ' || c == '\t';
+}
+
+inline bool IsStructural(char c)
+{
+	return c == '\n' || c == '\r' || c == '#' || c == ';' || c == '=';
+}
+
+//--------------------------------------------------------------------------
+// Fill a scanned line which ends at 'eol' (trimmed spans and brackets)
+inline void EmitLine(const char *t, size_t eol, const scanstate &st, scanline &l)
+{
+	size_t b = st.start;
+	while(b < eol && IsBlank(t[b]))
+		b++;
+	size_t e = eol;
+	while(e > b && IsBlank(t[e - 1]))
+		e--;
+	size_t body = (st.comment == npos) ? e : st.comment;
+	while(body > b && IsBlank(t[body - 1]))
+		body--;
+
+	l.begin = b;
+	l.end = e;
+	l.body = body;
+	l.comment = st.comment;
+	l.equal = st.equal;
+	l.open = (b < body && t[b] == '[') ? b : npos;
+	l.close = (l.open != npos && body - b > 1 && t[body - 1] == ']') ? body - 1 : npos;
+}
+
+//--------------------------------------------------------------------------
+// Handle a structural character found at 'i'. Returns true when the array
+// of lines is full and the scan must stop.
+inline bool ScanEvent(const char *t, size_t i, scanstate &st, scanline *lines, size_t max, size_t &count)
+{
+	char c = t[i];
+	if(c == '\n' || c == '\r')
+	{
+		// empty lines are ignored
+		if(i > st.start)
+		{
+			EmitLine(t, i, st, lines[count]);
+			count++;
+		}
+		st.start = i + 1;
+		st.comment = npos;
+		st.equal = npos;
+		return count == max;
+	}
+
+	if(st.comment == npos)
+	{
+		if(c != '=')
+			st.comment = i;
+		else if(st.equal == npos)
+			st.equal = i;
+	}
+	return false;
+}
+
+//--------------------------------------------------------------------------
+// Handle the bytes after the last block and the last line of the text
+inline size_t ScanEnd(const char *t, size_t i, size_t n, scanstate &st, scanline *lines, size_t max, size_t &count)
+{
+	for(; i < n; i++)
+	{
+		if(IsStructural(t[i]) && ScanEvent(t, i, st, lines, max, count))
+			return i + 1;
+	}
+
+	if(n > st.start)
+	{
+		if(count == max)
+			return st.start;
+		EmitLine(t, n, st, lines[count]);
+		count++;
+	}
+
+	return n;
+}
+
+//--------------------------------------------------------------------------
+// Scalar scanner, used when no vector instructions are available
+size_t ScanScalar(string_view text, size_t pos, scanline *lines, size_t max, size_t &count)
+{
+	scanstate st = {pos, npos, npos};
+	count = 0;
+
+	return ScanEnd(text.data(), pos, text.size(), st, lines, max, count);
+}
+
+#ifdef INI_SCANNER_X86
+//--------------------------------------------------------------------------
+// SSE2 scanner, 16 bytes are classified at once
+__attribute__((target("sse2")))
+size_t ScanSSE2(string_view text, size_t pos, scanline *lines, size_t max, size_t &count)
+{
+	const char *t = text.data();
+	size_t n = text.size();
+	scanstate st = {pos, npos, npos};
+	count = 0;
+
+	const __m128i nl = _mm_set1_epi8('\n');
+	const __m128i cr = _mm_set1_epi8('\r');
+	const __m128i sh = _mm_set1_epi8('#');
+	const __m128i sc = _mm_set1_epi8(';');
+	const __m128i eq = _mm_set1_epi8('=');
+
+	size_t i = pos;
+	for(; i + 16 <= n; i += 16)
+	{
+		__m128i b = _mm_loadu_si128((const __m128i *)(t + i));
+		__m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(b, nl), _mm_cmpeq_epi8(b, cr)),
+				_mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(b, sh), _mm_cmpeq_epi8(b, sc)), _mm_cmpeq_epi8(b, eq)));
+		unsigned int mask = (unsigned int)_mm_movemask_epi8(m);
+		while(mask != 0)
+		{
+			size_t k = i + __builtin_ctz(mask);
+			mask &= mask - 1;
+			if(ScanEvent(t, k, st, lines, max, count))
+				return k + 1;
+		}
+	}
+
+	return ScanEnd(t, i, n, st, lines, max, count);
+}
+
+//--------------------------------------------------------------------------
+// AVX2 scanner, 32 bytes are classified at once
+__attribute__((target("avx2")))
+size_t ScanAVX2(string_view text, size_t pos, scanline *lines, size_t max, size_t &count)
+{
+	const char *t = text.data();
+	size_t n = text.size();
+	scanstate st = {pos, npos, npos};
+	count = 0;
+
+	const __m256i nl = _mm256_set1_epi8('\n');
+	const __m256i cr = _mm256_set1_epi8('\r');
+	const __m256i sh = _mm256_set1_epi8('#');
+	const __m256i sc = _mm256_set1_epi8(';');
+	const __m256i eq = _mm256_set1_epi8('=');
+
+	size_t i = pos;
+	for(; i + 32 <= n; i += 32)
+	{
+		__m256i b = _mm256_loadu_si256((const __m256i *)(t + i));
+		__m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(b, nl), _mm256_cmpeq_epi8(b, cr)),
+				_mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(b, sh), _mm256_cmpeq_epi8(b, sc)), _mm256_cmpeq_epi8(b, eq)));
+		unsigned int mask = (unsigned int)_mm256_movemask_epi8(m);
+		while(mask != 0)
+		{
+			size_t k = i + __builtin_ctz(mask);
+			mask &= mask - 1;
+			if(ScanEvent(t, k, st, lines, max, count))
+				return k + 1;
+		}
+	}
+
+	return ScanEnd(t, i, n, st, lines, max, count);
+}
+#endif
+
+typedef size_t (*scanfunction)(string_view, size_t, scanline *, size_t, size_t &);
+
+//! \brief structure for the scanner selected for this processor
+struct scanner
+{
+	//! \brief the name of the scanner
+	const char *name;
+	//! \brief the scanning function
+	scanfunction function;
+};
+
+//--------------------------------------------------------------------------
+// Select the fastest scanner supported by the processor. The INI_SCANNER
+// environment variable can force a slower one ("scalar" or "sse2").
+scanner SelectScanner()
+{
+	const char *force = getenv("INI_SCANNER");
+	if(force == NULL)
+		force = "";
+
+#ifdef INI_SCANNER_X86
+	__builtin_cpu_init();
+	if(strcmp(force, "scalar") != 0 && strcmp(force, "sse2") != 0 && __builtin_cpu_supports("avx2"))
+		return scanner{"avx2", ScanAVX2};
+	if(strcmp(force, "scalar") != 0 && __builtin_cpu_supports("sse2"))
+		return scanner{"sse2", ScanSSE2};
+#endif
+
+	return scanner{"scalar", ScanScalar};
+}
+
+const scanner &Scanner()
+{
+	static const scanner s = SelectScanner();
+	return s;
+}
+
+}
+
+//--------------------------------------------------------------------------
+//                              SCANNER FUNCTIONS
+//--------------------------------------------------------------------------
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Scan the lines of an INI text
+//! \param    text    the text to scan
+//! \param    pos     the position where the scan starts (at the beginning of a line)
+//! \param    lines   an array receiving the lines found
+//! \param    max     the size of the array
+//! \param    count   receives the number of lines found
+//! \return   the position where the next scan must start
+//!
+//! This function classifies the text in one pass: it finds the line
+//! boundaries, the comment starts ('#' or ';'), the assignments ('='), the
+//! section brackets and the trimmed spans of every line. Empty lines are
+//! ignored. The text is read 32 or 16 bytes at once with AVX2 or SSE2
+//! instructions when the processor supports them.
+//!
+//! This function returns text.size() when the whole text has been scanned,
+//! otherwise the array is full and the scan has to be called again.
+//!
+//--------------------------------------------------------------------------
+size_t INIScan(string_view text, size_t pos, scanline *lines, size_t max, size_t &count)
+{
+	count = 0;
+	if(max == 0 || pos >= text.size())
+		return text.size();
+
+	return Scanner().function(text, pos, lines, max, count);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the name of the scanner
+//! \return   a char pointer to the name of the scanner
+//!
+//! This function returns "avx2", "sse2" or "scalar", depending on the
+//! instructions used by INIScan() on this processor.
+//!
+//--------------------------------------------------------------------------
+const char *INIScannerName()
+{
+	return Scanner().name;
+}
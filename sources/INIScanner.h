@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------
+//                                INISCANNER.H
+//--------------------------------------------------------------------------
+//!
+//! \file INIScanner.h
+//! \brief Header file for scanning the structure of INI text
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INIScannerH
+#define INIScannerH
+
+#include <string_view>
+
+//--------------------------------------------------------------------------
+//                              STRUCTURES DECLARATIONS
+//--------------------------------------------------------------------------
+
+//! \brief structure for a line found by the scanner
+//!
+//! All the positions are offsets in the scanned text. A position which is
+//! not found is std::string_view::npos.
+struct scanline
+{
+	//! \brief the first non blank character of the line
+	std::size_t begin;
+	//! \brief the end of the line without the trailing blanks
+	std::size_t end;
+	//! \brief the end of the text before the comment, without the trailing blanks
+	std::size_t body;
+	//! \brief the position of the '#' or ';' starting the comment
+	std::size_t comment;
+	//! \brief the position of the first '=' before the comment
+	std::size_t equal;
+	//! \brief the position of the '[' opening a section name (first character of the line)
+	std::size_t open;
+	//! \brief the position of the ']' closing a section name (last character before the comment)
+	std::size_t close;
+};
+
+//--------------------------------------------------------------------------
+//                              SCANNER FUNCTIONS
+//--------------------------------------------------------------------------
+
+std::size_t INIScan(std::string_view text, std::size_t pos, scanline *lines, std::size_t max, std::size_t &count);
+const char *INIScannerName();
+
+#endif
@@ -0,0 +1,689 @@
+//--------------------------------------------------------------------------
+//                                INISNAPSHOT.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INISnapshot.cpp
+//! \brief Functions for the read-only snapshots of an INI file
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#include <stdlib.h>
+#include <string.h>
+#include <fstream>
+
+#if __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+#include <sys/stat.h>
+
+#pragma hdrstop
+
+#include "INISnapshot.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              LOCAL FUNCTIONS
+//--------------------------------------------------------------------------
+
+namespace
+{
+
+//--------------------------------------------------------------------------
+// Copy a string at the end of the characters of an image
+snapshotstring StoreString(char *Chars, uint32_t &Used, string_view value)
+{
+	snapshotstring s;
+	s.offset = Used;
+	s.size = value.size();
+	if(value.size() > 0)
+		memcpy(Chars + Used, value.data(), value.size());
+	Used += value.size();
+	return s;
+}
+
+//--------------------------------------------------------------------------
+// Modification time of a file in nanoseconds
+int64_t ModificationTime(const struct stat &st)
+{
+#if __linux__
+	return (int64_t)st.st_mtim.tv_sec * 1000000000 + st.st_mtim.tv_nsec;
+#else
+	return (int64_t)st.st_mtime * 1000000000;
+#endif
+}
+
+//--------------------------------------------------------------------------
+// Check that an INI file is the one described by the header of an image.
+// The text is hashed only if the size is the same but not the time.
+bool SameSource(const snapshotheader *h, const char *Source)
+{
+	struct stat st;
+	if(stat(Source, &st) != 0 || (uint64_t)st.st_size != h->sourcesize)
+		return false;
+	if(ModificationTime(st) == h->sourcetime)
+		return true;
+
+	ifstream f(Source, ios::in | ios::binary);
+	if(!f.is_open())
+		return false;
+	string Text((size_t)st.st_size, '\0');
+	f.read(&Text[0], Text.size());
+	if((size_t)f.gcount() != Text.size())
+		return false;
+
+	return INIHash(Text) == h->sourcehash;
+}
+
+}
+
+//--------------------------------------------------------------------------
+//                              INISNAPSHOT METHODS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INISnapshot class
+//! \param    Parser    the parser to copy
+//! \param    Version   the version of the snapshot
+//! \return   an instance of the class
+//!
+//! This function copies the index of the parser into one block of memory.
+//! The parameters of a section are stored one after the other, and the key
+//! index keeps the slots of the parser, so a key is found the same way (the
+//! last declaration of a key wins).
+//! The image cannot be larger than 4 GB: the snapshot of a larger index is
+//! left empty, and IsValid() returns false.
+//!
+//--------------------------------------------------------------------------
+__CALL INISnapshot::INISnapshot(INIParser &Parser, unsigned long Version)
+{
+	this->Version = Version;
+	this->Mapping = NULL;
+	this->MappingSize = 0;
+	this->Header = NULL;
+
+	uint64_t nslot = Parser.Index.size();
+	uint64_t nsec = Parser.Sections.size();
+	uint64_t nparam = Parser.Params.size();
+	uint64_t chars = 0;
+	for(uint32_t i = 0; i < nsec; i++)
+		chars += Parser.Sections[i].key.size() + Parser.Sections[i].comment.size();
+	for(uint32_t j = 0; j < nparam; j++)
+	{
+		const parameterview &p = Parser.Params[j];
+		chars += p.name.size() + p.value.size() + p.comment.size();
+	}
+
+	// the sizes and the offsets of the image are 32-bit integers
+	uint64_t size = sizeof(snapshotheader) + nslot * sizeof(snapshotslot)
+			+ nsec * sizeof(snapshotsection) + nparam * sizeof(snapshotparam) + chars;
+	if(size > UINT32_MAX)
+		return;
+	this->Image.assign((size + 7) / 8, 0);
+
+	snapshotheader *h = (snapshotheader *)this->Image.data();
+	h->magic = INI_SNAPSHOT_MAGIC;
+	h->layout = INI_SNAPSHOT_LAYOUT;
+	h->size = size;
+	h->slots = nslot;
+	h->sections = nsec;
+	h->params = nparam;
+	h->chars = chars;
+	this->Attach(this->Image.data());
+
+	snapshotsection *Sec = (snapshotsection *)this->Sections;
+	snapshotparam *Par = (snapshotparam *)this->Params;
+	snapshotslot *Slot = (snapshotslot *)this->Slots;
+	char *Chars = (char *)this->Chars;
+	uint32_t used = 0;
+
+	// the parameters are renumbered section by section
+	vector<int> Map(nparam, -1);
+	uint32_t n = 0;
+	for(uint32_t i = 0; i < nsec; i++)
+	{
+		const sectionview &s = Parser.Sections[i];
+		Sec[i].key = StoreString(Chars, used, s.key);
+		Sec[i].comment = StoreString(Chars, used, s.comment);
+		Sec[i].line = Parser.Lines.Line(s.handle);
+		Sec[i].first = n;
+		Sec[i].count = 0;
+
+		for(int j = s.first; j >= 0; j = Parser.Params[j].next)
+		{
+			// the values are converted once for all the readers
+			Parser.Convert(j, 0);
+			Parser.Convert(j, 1);
+			Parser.Convert(j, 2);
+			const parameterview &p = Parser.Params[j];
+			Par[n].name = StoreString(Chars, used, p.name);
+			Par[n].value = StoreString(Chars, used, p.value);
+			Par[n].comment = StoreString(Chars, used, p.comment);
+			Par[n].line = Parser.Lines.Line(p.handle);
+			Par[n].sec = i;
+			Par[n].integer = p.integer;
+			Par[n].real = p.real;
+			Par[n].status[0] = p.status[0];
+			Par[n].status[1] = p.status[1];
+			Par[n].status[2] = p.status[2];
+			Par[n].boolean = p.boolean;
+			Map[j] = n;
+			n++;
+			Sec[i].count++;
+		}
+	}
+
+	for(uint32_t k = 0; k < nslot; k++)
+	{
+		const keyslot &e = Parser.Index[k];
+		Slot[k].hash = e.hash;
+		Slot[k].sec = e.sec;
+		Slot[k].param = (e.sec < 0 || e.param < 0) ? -1 : Map[e.param];
+	}
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Destructor of the INISnapshot class
+//!
+//! The image of a compiled file is unmapped.
+//!
+//--------------------------------------------------------------------------
+__CALL INISnapshot::~INISnapshot()
+{
+#if __linux__
+	if(this->Mapping != NULL)
+		munmap(this->Mapping, this->MappingSize);
+#endif
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Open a compiled INI file
+//! \param    File     the image written by INIParser::Compile()
+//! \param    Source   the INI file of the image (NULL to skip the check)
+//! \param    Verify   true to check the checksum of the whole image
+//! \return   the snapshot (NULL if the image is invalid or stale)
+//!
+//! On GNU/Linux the image is mapped read-only and used as it is, so the
+//! snapshot is ready once the header is checked, whatever the size of the
+//! file. With a source file, the image is stale if the size of the file
+//! has changed, or if its modification time has changed and its text is
+//! not the compiled one. The image is trusted unless Verify is true.
+//!
+//--------------------------------------------------------------------------
+shared_ptr<const INISnapshot> __CALL INISnapshot::Open(const char *File, const char *Source, bool Verify)
+{
+	shared_ptr<INISnapshot> s(new INISnapshot());
+	size_t size;
+	const void *base;
+
+#if __linux__
+	int fd = open(File, O_RDONLY | O_CLOEXEC);
+	if(fd < 0)
+		return NULL;
+
+	struct stat st;
+	if(fstat(fd, &st) != 0 || st.st_size < (off_t)sizeof(snapshotheader))
+	{
+		close(fd);
+		return NULL;
+	}
+	size = st.st_size;
+	void *m = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if(m == MAP_FAILED)
+		return NULL;
+	s->Mapping = m;
+	s->MappingSize = size;
+	base = m;
+#else
+	ifstream f(File, ios::in | ios::binary | ios::ate);
+	if(!f.is_open())
+		return NULL;
+	size = f.tellg();
+	if(size < sizeof(snapshotheader))
+		return NULL;
+	s->Image.assign((size + 7) / 8, 0);
+	f.seekg(0);
+	f.read((char *)s->Image.data(), size);
+	if(f.fail())
+		return NULL;
+	base = s->Image.data();
+#endif
+
+	const snapshotheader *h = (const snapshotheader *)base;
+	uint64_t expected = sizeof(snapshotheader) + (uint64_t)h->slots * sizeof(snapshotslot)
+			+ (uint64_t)h->sections * sizeof(snapshotsection)
+			+ (uint64_t)h->params * sizeof(snapshotparam) + h->chars;
+	if(h->magic != INI_SNAPSHOT_MAGIC || h->layout != INI_SNAPSHOT_LAYOUT || h->size != size
+			|| expected != size || (h->slots & (h->slots - 1)) != 0)
+		return NULL;
+
+	if(Verify && INIHash(string_view((const char *)base + sizeof(snapshotheader), size - sizeof(snapshotheader))) != h->checksum)
+		return NULL;
+	if(Source != NULL && !SameSource(h, Source))
+		return NULL;
+
+	s->Attach(base);
+	return s;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the version of the snapshot
+//! \return   the version given by INIParser::Publish()
+//!
+//--------------------------------------------------------------------------
+unsigned long __CALL INISnapshot::GetVersion() const
+{
+	return this->Version;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the image of the snapshot
+//! \return   a pointer to the first byte of the image
+//!
+//! The image only contains offsets (see snapshotheader), so it can be
+//! copied as it is.
+//!
+//--------------------------------------------------------------------------
+const void * __CALL INISnapshot::Data() const
+{
+	return this->Header;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Check that the snapshot has an image
+//! \return   false if the index of the parser was too large to be copied
+//!
+//! The other functions must not be called on an invalid snapshot.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INISnapshot::IsValid() const
+{
+	return this->Header != NULL;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the size of the image of the snapshot
+//! \return   the size of the image in bytes
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INISnapshot::Size() const
+{
+	return this->Header->size;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the characters of a string of the snapshot
+//! \param    s    a string of a section or a parameter of the snapshot
+//! \return   a view of the string, valid as long as the snapshot
+//!
+//--------------------------------------------------------------------------
+string_view __CALL INISnapshot::Text(const snapshotstring &s) const
+{
+	return string_view(this->Chars + s.offset, s.size);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the sections name of the snapshot
+//! \return   a vector of strings with the sections name
+//!
+//--------------------------------------------------------------------------
+vector<string> __CALL INISnapshot::GetSectionsName() const
+{
+	vector<string> Keys;
+	Keys.reserve(this->Header->sections);
+	for(uint32_t i = 0; i < this->Header->sections; i++)
+		Keys.push_back(string(this->Text(this->Sections[i].key)));
+
+	return Keys;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the sections number of the snapshot
+//! \return   an integer representing the sections number
+//!
+//--------------------------------------------------------------------------
+int __CALL INISnapshot::GetSectionNumber() const
+{
+	return this->Header->sections;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a specified section of the snapshot
+//! \param    SectionName  a char pointer for the section name to get
+//! \return   a section structure
+//!
+//! If the specified section cannot be foud, this function returns an empty section.
+//!
+//--------------------------------------------------------------------------
+section __CALL INISnapshot::GetSection(const char *SectionName) const
+{
+	section sd;
+	const snapshotsection *s = this->Find(SectionName);
+
+	if(s == NULL)
+	{
+		sd.key = "";
+		return sd;
+	}
+
+	sd.key = string(this->Text(s->key));
+	sd.comment = string(this->Text(s->comment));
+	sd.line = s->line;
+	for(uint32_t j = s->first; j < s->first + s->count; j++)
+	{
+		const snapshotparam &p = this->Params[j];
+		parameter pd;
+		pd.name = string(this->Text(p.name));
+		pd.value = string(this->Text(p.value));
+		pd.comment = string(this->Text(p.comment));
+		pd.line = p.line;
+		sd.parameters.push_back(pd);
+	}
+
+	return sd;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a section
+//! \param    section    the section name
+//! \return   a pointer to the section structure (NULL if it cannot be found)
+//!
+//! The returned pointer is valid as long as the snapshot.
+//!
+//--------------------------------------------------------------------------
+const snapshotsection * __CALL INISnapshot::Find(string_view section) const
+{
+	int k = this->IndexFind(INIHashSection(section), section, "", true);
+
+	if(k < 0)
+		return NULL;
+
+	return &(this->Sections[this->Slots[k].sec]);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Find a parameter
+//! \param    section    the section name
+//! \param    key        the parameter name
+//! \return   a pointer to the parameter structure (NULL if it cannot be found)
+//!
+//! The returned pointer is valid as long as the snapshot.
+//!
+//--------------------------------------------------------------------------
+const snapshotparam * __CALL INISnapshot::Find(string_view section, string_view key) const
+{
+	int k = this->IndexFind(INIHashKey(section, key), section, key, false);
+
+	if(k < 0)
+		return NULL;
+
+	return &(this->Params[this->Slots[k].param]);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a boolean value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a boolean representing the value of the specified key
+//!
+//! If the value is "true" or 1, the returned value is true, false otherwise
+//!
+//--------------------------------------------------------------------------
+bool __CALL INISnapshot::GetBoolean(const char *section, const char *key) const
+{
+	const snapshotparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return false;
+
+	return p->boolean != 0;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a string value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a string representing the value of the specified key
+//!
+//--------------------------------------------------------------------------
+string __CALL INISnapshot::GetString(const char *section, const char *key) const
+{
+	const snapshotparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return "";
+
+	return string(this->Text(p->value));
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get an integer value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   an integer representing the value of the specified key
+//!
+//! If the value cannot be converted into integer, 0 is returned
+//!
+//--------------------------------------------------------------------------
+int __CALL INISnapshot::GetInteger(const char *section, const char *key) const
+{
+	const snapshotparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return 0;
+
+	return int(p->integer);
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a double value
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \return   a double representing the value of the specified key
+//!
+//! If the value cannot be converted into double, 0.0 is returned
+//!
+//--------------------------------------------------------------------------
+double __CALL INISnapshot::GetDouble(const char *section, const char *key) const
+{
+	const snapshotparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return 0.0;
+
+	return p->real;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a boolean value, and whether it exists and is valid
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the boolean value of the specified key
+//! \return   INI_VALUE_OK, INI_VALUE_MISSING or INI_VALUE_MALFORMED
+//!
+//! See INIParser::TryGetBoolean().
+//!
+//--------------------------------------------------------------------------
+INIValueStatus __CALL INISnapshot::TryGetBoolean(const char *section, const char *key, bool &value) const
+{
+	const snapshotparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return INI_VALUE_MISSING;
+
+	if(p->status[2] == INI_VALUE_OK)
+		value = p->boolean != 0;
+	return (INIValueStatus)p->status[2];
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get an integer value, and whether it exists and is valid
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the integer value of the specified key
+//! \return   INI_VALUE_OK, INI_VALUE_MISSING or INI_VALUE_MALFORMED
+//!
+//! See INIParser::TryGetInteger().
+//!
+//--------------------------------------------------------------------------
+INIValueStatus __CALL INISnapshot::TryGetInteger(const char *section, const char *key, long long &value) const
+{
+	const snapshotparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return INI_VALUE_MISSING;
+
+	if(p->status[0] == INI_VALUE_OK)
+		value = p->integer;
+	return (INIValueStatus)p->status[0];
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get a double value, and whether it exists and is valid
+//! \param    section    a char pointer to the section name
+//! \param    key        a char pointer to the parameter name
+//! \param    value      the double value of the specified key
+//! \return   INI_VALUE_OK, INI_VALUE_MISSING or INI_VALUE_MALFORMED
+//!
+//! See INIParser::TryGetDouble().
+//!
+//--------------------------------------------------------------------------
+INIValueStatus __CALL INISnapshot::TryGetDouble(const char *section, const char *key, double &value) const
+{
+	const snapshotparam *p = this->Find(section, key);
+
+	if(p == NULL)
+		return INI_VALUE_MISSING;
+
+	if(p->status[1] == INI_VALUE_OK)
+		value = p->real;
+	return (INIValueStatus)p->status[1];
+}
+
+// --------------------------------------------------------------------------
+// Empty snapshot, for Open()
+__CALL INISnapshot::INISnapshot()
+{
+	this->Mapping = NULL;
+	this->MappingSize = 0;
+	this->Version = 0;
+	this->Header = NULL;
+}
+
+// --------------------------------------------------------------------------
+// Set the pointers to the parts of the image
+void __CALL INISnapshot::Attach(const void *Base)
+{
+	const char *base = (const char *)Base;
+	this->Header = (const snapshotheader *)base;
+	this->Slots = (const snapshotslot *)(base + sizeof(snapshotheader));
+	this->Sections = (const snapshotsection *)(this->Slots + this->Header->slots);
+	this->Params = (const snapshotparam *)(this->Sections + this->Header->sections);
+	this->Chars = (const char *)(this->Params + this->Header->params);
+}
+
+// --------------------------------------------------------------------------
+// Describe the INI file of the image and compute its checksum (see
+// INIParser::Compile())
+void __CALL INISnapshot::Seal(uint64_t SourceSize, int64_t SourceTime, uint64_t SourceHash)
+{
+	snapshotheader *h = (snapshotheader *)this->Image.data();
+	h->sourcesize = SourceSize;
+	h->sourcetime = SourceTime;
+	h->sourcehash = SourceHash;
+	h->checksum = INIHash(string_view((const char *)h + sizeof(snapshotheader), h->size - sizeof(snapshotheader)));
+}
+
+// --------------------------------------------------------------------------
+// Look for an entry in the key index (see INIParser::IndexFind())
+int __CALL INISnapshot::IndexFind(unsigned long long hash, string_view section, string_view key, bool IsSection) const
+{
+	if(this->Header->slots == 0)
+		return -1;
+
+	size_t mask = this->Header->slots - 1;
+	for(size_t k = hash & mask; ; k = (k + 1) & mask)
+	{
+		const snapshotslot &e = this->Slots[k];
+		if(e.sec < 0)
+			return -1;
+		if(e.hash != hash || (e.param < 0) != IsSection)
+			continue;
+
+		if(this->Text(this->Sections[e.sec].key) == section && (IsSection || this->Text(this->Params[e.param].name) == key))
+			return k;
+	}
+}
+
+//--------------------------------------------------------------------------
+//                              INISNAPSHOTREADER METHODS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INISnapshotReader class
+//! \param    Parser   the parser publishing the snapshots
+//! \return   an instance of the class
+//!
+//! The parser must live longer than the reader.
+//!
+//--------------------------------------------------------------------------
+__CALL INISnapshotReader::INISnapshotReader(INIParser *Parser)
+{
+	this->Parser = Parser;
+	this->Version = 0;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Get the last snapshot of the parser
+//! \return   a pointer to the snapshot (NULL if none has been published)
+//!
+//! This function only loads the version of the parser (an atomic integer),
+//! unless a new snapshot has been published since the last call. The
+//! returned snapshot is valid until the next call, even if the parser
+//! publishes a new one meanwhile.
+//!
+//--------------------------------------------------------------------------
+const INISnapshot * __CALL INISnapshotReader::Get()
+{
+	if(this->Parser->GetVersion() != this->Version)
+	{
+		this->Current = this->Parser->Snapshot();
+		this->Version = this->Current ? this->Current->GetVersion() : 0;
+	}
+
+	return this->Current.get();
+}
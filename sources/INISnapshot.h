@@ -0,0 +1,222 @@
+//--------------------------------------------------------------------------
+//                                INISNAPSHOT.H
+//--------------------------------------------------------------------------
+//!
+//! \file INISnapshot.h
+//! \brief Header file for the read-only snapshots of an INI file
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INISnapshotH
+#define INISnapshotH
+
+#include <stdint.h>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <memory>
+
+#include "INIParser.h"
+
+//--------------------------------------------------------------------------
+//                              STRUCTURES DECLARATIONS
+//--------------------------------------------------------------------------
+
+//! \brief the magic number of a snapshot image ("INIS")
+#define INI_SNAPSHOT_MAGIC 0x53494E49U
+//! \brief the version of the layout of a snapshot image
+#define INI_SNAPSHOT_LAYOUT 2U
+
+//! \brief structure for the header of a snapshot image
+//!
+//! A snapshot image is one block of memory: the header, the key index, the
+//! sections, the parameters and the characters of the strings. It only
+//! contains offsets, so it can be copied or mapped anywhere. An image
+//! written by INIParser::Compile() also describes the INI file it comes
+//! from, so INISnapshot::Open() can tell whether it is stale.
+struct snapshotheader
+{
+	//! \brief INI_SNAPSHOT_MAGIC
+	uint32_t magic;
+	//! \brief INI_SNAPSHOT_LAYOUT
+	uint32_t layout;
+	//! \brief the size of the image in bytes
+	uint32_t size;
+	//! \brief the number of slots of the key index (a power of 2)
+	uint32_t slots;
+	//! \brief the number of sections
+	uint32_t sections;
+	//! \brief the number of parameters
+	uint32_t params;
+	//! \brief the number of characters of the strings
+	uint32_t chars;
+	//! \brief reserved (0)
+	uint32_t reserved;
+	//! \brief the hash of the image after the header (0 if not computed)
+	uint64_t checksum;
+	//! \brief the size of the INI file in bytes
+	uint64_t sourcesize;
+	//! \brief the modification time of the INI file in nanoseconds
+	int64_t sourcetime;
+	//! \brief the hash of the text of the INI file
+	uint64_t sourcehash;
+};
+
+//! \brief structure for a string of a snapshot image
+struct snapshotstring
+{
+	//! \brief the offset of the first character in the characters of the image
+	uint32_t offset;
+	//! \brief the number of characters
+	uint32_t size;
+};
+
+//! \brief structure for an entry of the key index of a snapshot image
+struct snapshotslot
+{
+	//! \brief the hash of the section name (and of the parameter name)
+	uint64_t hash;
+	//! \brief the index of the section (-1 for an empty slot)
+	int32_t sec;
+	//! \brief the index of the parameter (-1 for a section)
+	int32_t param;
+};
+
+//! \brief structure for a section of a snapshot image
+struct snapshotsection
+{
+	//! \brief the name of the section
+	snapshotstring key;
+	//! \brief the comment of the section
+	snapshotstring comment;
+	//! \brief the line of the section in the ini file
+	uint32_t line;
+	//! \brief the index of the first parameter of the section
+	uint32_t first;
+	//! \brief the number of parameters of the section (they follow the first one)
+	uint32_t count;
+	//! \brief reserved (0)
+	uint32_t reserved;
+};
+
+//! \brief structure for a parameter of a snapshot image
+struct snapshotparam
+{
+	//! \brief the name of the parameter
+	snapshotstring name;
+	//! \brief the value of the parameter
+	snapshotstring value;
+	//! \brief the comment of the parameter
+	snapshotstring comment;
+	//! \brief the line of the parameter in the ini file
+	uint32_t line;
+	//! \brief the index of the section of the parameter
+	uint32_t sec;
+	//! \brief the value converted into an integer (see INIToInteger())
+	int64_t integer;
+	//! \brief the value converted into a double (see INIToDouble())
+	double real;
+	//! \brief the status of the conversions into integer, double and boolean (INIValueStatus)
+	uint8_t status[3];
+	//! \brief the value converted into a boolean (see INIToBoolean())
+	uint8_t boolean;
+	//! \brief reserved (0)
+	uint32_t reserved;
+};
+
+//--------------------------------------------------------------------------
+//                              INISNAPSHOT CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INISnapshot
+//! \brief INISnapshot class.
+//!
+//! This class is a read-only copy of the index of an INIParser. It is never
+//! modified once built, so any number of threads can read it at the same
+//! time without synchronization. See INIParser::Publish() and the
+//! INISnapshotReader class.
+//! The values are converted once when the snapshot is built. An image
+//! compiled into a file by INIParser::Compile() is mapped back by Open().
+//!
+//--------------------------------------------------------------------------
+class INISnapshot
+{
+	private:
+		std::vector<uint64_t> Image;
+		void *Mapping;
+		std::size_t MappingSize;
+		const snapshotheader *Header;
+		const snapshotslot *Slots;
+		const snapshotsection *Sections;
+		const snapshotparam *Params;
+		const char *Chars;
+		unsigned long Version;
+
+		__CALL INISnapshot();
+		void __CALL Attach(const void *Base);
+		void __CALL Seal(uint64_t SourceSize, int64_t SourceTime, uint64_t SourceHash);
+		int __CALL IndexFind(unsigned long long hash, std::string_view section, std::string_view key, bool IsSection) const;
+
+	public:
+		__CALL INISnapshot(INIParser &Parser, unsigned long Version);
+		INISnapshot(const INISnapshot &) = delete;
+		INISnapshot &operator=(const INISnapshot &) = delete;
+		__CALL ~INISnapshot();
+		static std::shared_ptr<const INISnapshot> __CALL Open(const char *File, const char *Source=NULL, bool Verify=false);
+
+		bool __CALL IsValid() const;
+		unsigned long __CALL GetVersion() const;
+		const void * __CALL Data() const;
+		std::size_t __CALL Size() const;
+		std::string_view __CALL Text(const snapshotstring &s) const;
+
+		std::vector<std::string> __CALL GetSectionsName() const;
+		int __CALL GetSectionNumber() const;
+		section __CALL GetSection(const char *SectionName) const;
+		const snapshotsection * __CALL Find(std::string_view section) const;
+		const snapshotparam * __CALL Find(std::string_view section, std::string_view key) const;
+		bool __CALL GetBoolean(const char *section, const char *key) const;
+		std::string __CALL GetString(const char *section, const char *key) const;
+		int __CALL GetInteger(const char *section, const char *key) const;
+		double __CALL GetDouble(const char *section, const char *key) const;
+		INIValueStatus __CALL TryGetBoolean(const char *section, const char *key, bool &value) const;
+		INIValueStatus __CALL TryGetInteger(const char *section, const char *key, long long &value) const;
+		INIValueStatus __CALL TryGetDouble(const char *section, const char *key, double &value) const;
+
+		friend class INIParser;
+};
+
+//-------------------------------------------------------------------------
+//!
+//! \class INISnapshotReader
+//! \brief INISnapshotReader class.
+//!
+//! This class gives the last snapshot published by a parser to one thread.
+//! It keeps its own reference to the snapshot and only loads an atomic
+//! counter of the parser while the parser does not publish a new snapshot.
+//! The new snapshot is then copied without taking a lock (see
+//! INIParser::Snapshot()).
+//!
+//--------------------------------------------------------------------------
+class INISnapshotReader
+{
+	private:
+		INIParser *Parser;
+		unsigned long Version;
+		std::shared_ptr<const INISnapshot> Current;
+
+	public:
+		__CALL INISnapshotReader(INIParser *Parser);
+		const INISnapshot * __CALL Get();
+};
+
+#endif
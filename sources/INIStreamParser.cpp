@@ -0,0 +1,241 @@
+//--------------------------------------------------------------------------
+//                                INISTREAMPARSER.CPP
+//--------------------------------------------------------------------------
+//!
+//! \file INIStreamParser.cpp
+//! \brief Functions for parsing INI files by chunks
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#include <string.h>
+#include <fstream>
+
+#pragma hdrstop
+
+#include "INIStreamParser.h"
+
+//--------------------------------------------------------------------------
+
+using namespace std;
+
+//--------------------------------------------------------------------------
+//                              PUBLIC FUNCTIONS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Constructor of the INIStreamParser class
+//! \param    ChunkSize   the number of characters read at once
+//! \param    MaxLine     the length of the longest line which can be read
+//! \return   an instance of the class
+//!
+//! The buffer of the parser (ChunkSize + MaxLine + 1 characters) is allocated
+//! once here. A line longer than MaxLine characters (without its leading
+//! blanks) is given to INIHandler::OnError() (its first MaxLine characters
+//! only) and skipped, whatever the size of the chunks.
+//!
+//--------------------------------------------------------------------------
+__CALL INIStreamParser::INIStreamParser(size_t ChunkSize, size_t MaxLine)
+{
+	this->ChunkSize = (ChunkSize == 0) ? 1 : ChunkSize;
+	this->MaxLine = MaxLine;
+	this->Buffer.resize(this->ChunkSize + this->MaxLine + 1);
+	this->Offset = 0;
+	this->InSection = false;
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Parse an INI file
+//! \param    File      the INI file to parse
+//! \param    Handler   the handler receiving the lines
+//! \return   true if the whole file has been parsed
+//!
+//! This function returns false if the file cannot be read or if the
+//! handler has stopped the parsing.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIStreamParser::Parse(const char *File, INIHandler &Handler)
+{
+	ifstream f;
+	f.open(File, ios::in | ios::binary);
+
+	if(!f.is_open())
+		return false;
+
+	return this->Parse(f, Handler);
+}
+
+//-------------------------------------------------------------------------
+//!
+//! \brief    Parse an INI text read from a stream
+//! \param    In        the stream to read
+//! \param    Handler   the handler receiving the lines
+//! \return   true if the whole stream has been parsed
+//!
+//! The stream is read by chunks. The complete lines of a chunk are scanned
+//! at once, and the characters after its last line break are moved at the
+//! beginning of the buffer to be completed by the next chunk.
+//!
+//--------------------------------------------------------------------------
+bool __CALL INIStreamParser::Parse(istream &In, INIHandler &Handler)
+{
+	this->Offset = 0;
+	this->Section.clear();
+	this->InSection = false;
+
+	size_t used = 0;
+	size_t base = 0;
+	bool skipping = false;
+	bool end = false;
+	while(!end)
+	{
+		In.read(this->Buffer.data() + used, this->ChunkSize);
+		size_t got = In.gcount();
+		if(In.bad())
+			return false;
+		end = got < this->ChunkSize;
+		used += got;
+
+		// the end of a too long line is skipped
+		const char *b = this->Buffer.data();
+		size_t start = 0;
+		if(skipping)
+		{
+			while(start < used && b[start] != '\n' && b[start] != '\r')
+				start++;
+			if(start == used && !end)
+			{
+				base += used;
+				used = 0;
+				continue;
+			}
+			skipping = false;
+		}
+
+		// the characters after the last line break wait for the next chunk
+		size_t cut = used;
+		if(!end)
+		{
+			while(cut > start && b[cut - 1] != '\n' && b[cut - 1] != '\r')
+				cut--;
+		}
+
+		if(!this->ParseLines(string_view(b, cut), start, base, Handler))
+			return false;
+
+		// the leading blanks do not count in the length of the line (see
+		// ParseLines()), and only the last one is kept
+		size_t first = cut;
+		while(first < used && (b[first] == ' ' || b[first] == '\t'))
+			first++;
+		if(used - first > this->MaxLine)
+		{
+			this->Offset = base + first;
+			if(!Handler.OnError(string_view(b + first, this->MaxLine), base + first))
+				return false;
+			skipping = true;
+			base += used;
+			used = 0;
+		}
+		else
+		{
+			if(first > cut)
+				cut = first - 1;
+			memmove(this->Buffer.data(), b + cut, used - cut);
+			base += cut;
+			used -= cut;
+		}
+	}
+
+	this->Offset = base + used;
+	return true;
+}
+
+//--------------------------------------------------------------------------
+//!
+//! \brief Get the position of the parsing
+//! \return   the offset of the last line given to the handler, or the size
+//!           of the input once it has been parsed
+//!
+//--------------------------------------------------------------------------
+size_t __CALL INIStreamParser::GetOffset()
+{
+	return this->Offset;
+}
+
+//--------------------------------------------------------------------------
+//                              PRIVATE FUNCTIONS
+//--------------------------------------------------------------------------
+
+// --------------------------------------------------------------------------
+// Give the complete lines of the buffer to the handler, from 'pos' ('base'
+// is the offset of the buffer in the input). The lines longer than MaxLine
+// are errors, as the ones cut by Parse().
+bool __CALL INIStreamParser::ParseLines(string_view text, size_t pos, size_t base, INIHandler &Handler)
+{
+	scanline sl[256];
+	while(pos < text.size())
+	{
+		size_t nl;
+		pos = INIScan(text, pos, sl, 256, nl);
+
+		for(size_t i = 0; i < nl; i++)
+		{
+			// the lines of blanks are ignored, as the empty ones
+			const scanline &L = sl[i];
+			if(L.begin == L.end)
+				continue;
+			size_t offset = base + L.begin;
+			this->Offset = offset;
+
+			// the line ends with its trailing blanks
+			size_t eol = L.end;
+			while(eol < text.size() && (text[eol] == ' ' || text[eol] == '\t'))
+				eol++;
+			if(eol - L.begin > this->MaxLine)
+			{
+				if(!Handler.OnError(text.substr(L.begin, this->MaxLine), offset))
+					return false;
+				continue;
+			}
+
+			lineview lv;
+			sectionview s;
+			parameterview p;
+			int kind = INIParser::ParseLine(text, L, this->InSection, lv, s, p);
+
+			bool next;
+			if(kind == 1)
+			{
+				this->Section.assign(s.key);
+				this->InSection = true;
+				next = Handler.OnSection(this->Section, s.comment, offset);
+			}
+			else if(kind == 2)
+			{
+				next = Handler.OnParameter(this->Section, p.name, p.value, p.comment, offset);
+			}
+			else if(L.comment == L.begin)
+			{
+				next = Handler.OnComment(lv.text, offset);
+			}
+			else
+			{
+				next = Handler.OnError(lv.text, offset);
+			}
+
+			if(!next)
+				return false;
+		}
+	}
+
+	return true;
+}
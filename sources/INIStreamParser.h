@@ -0,0 +1,93 @@
+//--------------------------------------------------------------------------
+//                                INISTREAMPARSER.H
+//--------------------------------------------------------------------------
+//!
+//! \file INIStreamParser.h
+//! \brief Header file for parsing INI files by chunks
+//! \author Maxime Fontaine
+//! \version 0.1
+//! \date 2015-02-08
+//!
+//--------------------------------------------------------------------------
+
+
+//--------------------------------------------------------------------------
+//                            PRE-COMPILER DECLARATIONS
+//--------------------------------------------------------------------------
+#ifndef INIStreamParserH
+#define INIStreamParserH
+
+#include <iosfwd>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "INIParser.h"
+
+//--------------------------------------------------------------------------
+//                              INIHANDLER CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INIHandler
+//! \brief INIHandler class.
+//!
+//! This class receives the lines read by an INIStreamParser. The views are
+//! only valid during the call, and the offsets are the positions of the
+//! first non blank character of the lines in the input. A function returns
+//! false to stop the parsing. The empty lines and the lines of blanks are
+//! not given to the handler. By default, every line is ignored.
+//!
+//--------------------------------------------------------------------------
+class INIHandler
+{
+	public:
+		virtual ~INIHandler() {}
+
+		//! \brief a section begins (the comment is trimmed, without its '#' or ';')
+		virtual bool __CALL OnSection(std::string_view /*key*/, std::string_view /*comment*/, std::size_t /*offset*/) { return true; }
+		//! \brief a parameter of the current section
+		virtual bool __CALL OnParameter(std::string_view /*section*/, std::string_view /*name*/, std::string_view /*value*/, std::string_view /*comment*/, std::size_t /*offset*/) { return true; }
+		//! \brief a comment line (with its '#' or ';')
+		virtual bool __CALL OnComment(std::string_view /*text*/, std::size_t /*offset*/) { return true; }
+		//! \brief a line which is neither a section, nor a parameter, nor a comment
+		virtual bool __CALL OnError(std::string_view /*line*/, std::size_t /*offset*/) { return true; }
+};
+
+//--------------------------------------------------------------------------
+//                              INISTREAMPARSER CLASS
+//--------------------------------------------------------------------------
+
+//-------------------------------------------------------------------------
+//!
+//! \class INIStreamParser
+//! \brief INIStreamParser class.
+//!
+//! This class reads an INI file by chunks of a fixed size and gives its
+//! lines to an INIHandler, without keeping them. The lines are read as
+//! INIParser::Open() does, and a line cut by the end of a chunk is kept for
+//! the next one, so the memory only depends on the size of the chunks and
+//! on the length of the longest line.
+//!
+//--------------------------------------------------------------------------
+class INIStreamParser
+{
+	private:
+		std::vector<char> Buffer;
+		std::size_t ChunkSize;
+		std::size_t MaxLine;
+		std::size_t Offset;
+		std::string Section;
+		bool InSection;
+
+		bool __CALL ParseLines(std::string_view text, std::size_t pos, std::size_t base, INIHandler &Handler);
+
+	public:
+		__CALL INIStreamParser(std::size_t ChunkSize=65536, std::size_t MaxLine=65536);
+		bool __CALL Parse(const char *File, INIHandler &Handler);
+		bool __CALL Parse(std::istream &In, INIHandler &Handler);
+		std::size_t __CALL GetOffset();
+};
+
+#endif
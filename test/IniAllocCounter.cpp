@@ -0,0 +1,79 @@
+//---------------------------------------------------------------------------
+#include <atomic>
+#include <new>
+#include <stdlib.h>
+#include <malloc.h>
+
+#pragma hdrstop
+
+#include "IniAllocCounter.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Every allocation of the program is counted, with the usable size of its
+// block. The operators are kept in their own file, so they are never inlined
+// into the code using them.
+
+atomic<unsigned long long> Allocations(0);
+atomic<long long> AllocatedBytes(0);
+atomic<long long> FailedAllocation(0);
+
+namespace
+{
+
+void Fail()
+{
+	if(FailedAllocation.load(memory_order_relaxed) > 0 && FailedAllocation.fetch_sub(1, memory_order_relaxed) == 1)
+		throw bad_alloc();
+}
+
+void Free(void *p)
+{
+	if(p != NULL)
+		AllocatedBytes.fetch_sub(malloc_usable_size(p), memory_order_relaxed);
+	free(p);
+}
+
+}
+
+void *operator new(size_t size)
+{
+	Allocations.fetch_add(1, memory_order_relaxed);
+	Fail();
+	void *p = malloc(size == 0 ? 1 : size);
+	if(p == NULL)
+		throw bad_alloc();
+	AllocatedBytes.fetch_add(malloc_usable_size(p), memory_order_relaxed);
+	return p;
+}
+
+void *operator new[](size_t size)
+{
+	return operator new(size);
+}
+
+void *operator new(size_t size, align_val_t align)
+{
+	Allocations.fetch_add(1, memory_order_relaxed);
+	Fail();
+	void *p = NULL;
+	if(posix_memalign(&p, (size_t)align < sizeof(void *) ? sizeof(void *) : (size_t)align, size == 0 ? 1 : size) != 0)
+		throw bad_alloc();
+	AllocatedBytes.fetch_add(malloc_usable_size(p), memory_order_relaxed);
+	return p;
+}
+
+void *operator new[](size_t size, align_val_t align)
+{
+	return operator new(size, align);
+}
+
+void operator delete(void *p) noexcept { Free(p); }
+void operator delete[](void *p) noexcept { Free(p); }
+void operator delete(void *p, size_t) noexcept { Free(p); }
+void operator delete[](void *p, size_t) noexcept { Free(p); }
+void operator delete(void *p, align_val_t) noexcept { Free(p); }
+void operator delete[](void *p, align_val_t) noexcept { Free(p); }
+void operator delete(void *p, size_t, align_val_t) noexcept { Free(p); }
+void operator delete[](void *p, size_t, align_val_t) noexcept { Free(p); }
@@ -0,0 +1,17 @@
+//---------------------------------------------------------------------------
+#ifndef IniAllocCounterH
+#define IniAllocCounterH
+
+#include <atomic>
+
+//---------------------------------------------------------------------------
+// Number of allocations made by the program, and size of the blocks still
+// allocated (see IniAllocCounter.cpp, which replaces the global operators
+// new and delete). When FailedAllocation is set to n, the n-th allocation
+// which follows throws std::bad_alloc.
+
+extern std::atomic<unsigned long long> Allocations;
+extern std::atomic<long long> AllocatedBytes;
+extern std::atomic<long long> FailedAllocation;
+
+#endif
@@ -0,0 +1,194 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <list>
+#include <memory>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+
+#pragma hdrstop
+
+#include "INICache.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Write a file
+void Save(const string &File, const string &Text)
+{
+	ofstream f(File.c_str(), ios::out | ios::binary);
+	f << Text;
+}
+
+//---------------------------------------------------------------------------
+// Set the modification time of a file (in seconds)
+void SetTime(const string &File, time_t Time)
+{
+	struct timespec t[2];
+	t[0].tv_sec = Time;
+	t[0].tv_nsec = 0;
+	t[1] = t[0];
+	utimensat(AT_FDCWD, File.c_str(), t, 0);
+}
+
+//---------------------------------------------------------------------------
+// Check a result
+int Expect(const char *What, bool Success)
+{
+	if(!Success)
+		cout << What << " : failed" << endl;
+	return Success ? 0 : 1;
+}
+
+//---------------------------------------------------------------------------
+// A cached file is parsed again once it has changed: its size, its
+// modification time or its inode (a file replaced by another one with the
+// same size and time). The old snapshots stay valid.
+int Stale(const string &File)
+{
+	int Failures = 0;
+	INICache Cache;
+
+	Save(File, "[a]\nx = 1\n");
+	SetTime(File, 1000000000);
+	shared_ptr<const INISnapshot> s1 = Cache.Open(File.c_str());
+	shared_ptr<const INISnapshot> s2 = Cache.Open(File.c_str());
+	Failures += Expect("unchanged", s1 && s1 == s2 && Cache.GetCount() == 1 && Cache.GetSize() == s1->Size());
+
+	// a new size
+	Save(File, "[a]\nx = 10\n");
+	SetTime(File, 1000000000);
+	shared_ptr<const INISnapshot> s3 = Cache.Open(File.c_str());
+	Failures += Expect("size", s3 && s3 != s1 && s3->GetInteger("a", "x") == 10 && s1->GetInteger("a", "x") == 1);
+
+	// the same size, a new time
+	Save(File, "[a]\nx = 20\n");
+	SetTime(File, 1000000001);
+	shared_ptr<const INISnapshot> s4 = Cache.Open(File.c_str());
+	Failures += Expect("time", s4 && s4 != s3 && s4->GetInteger("a", "x") == 20 && s3->GetInteger("a", "x") == 10);
+
+	// the same size and time, another inode
+	string Other = File + ".new";
+	Save(Other, "[a]\nx = 30\n");
+	SetTime(Other, 1000000001);
+	rename(Other.c_str(), File.c_str());
+	shared_ptr<const INISnapshot> s5 = Cache.Open(File.c_str());
+	Failures += Expect("inode", s5 && s5 != s4 && s5->GetInteger("a", "x") == 30 && s4->GetInteger("a", "x") == 20);
+	Failures += Expect("one entry", Cache.GetCount() == 1 && Cache.GetSize() == s5->Size() && Cache.Open(File.c_str()) == s5);
+
+	// a removed file is removed from the cache
+	remove(File.c_str());
+	Failures += Expect("removed", !Cache.Open(File.c_str()) && Cache.GetCount() == 0 && Cache.GetSize() == 0 && s5->GetInteger("a", "x") == 30);
+
+	return Failures;
+}
+
+//---------------------------------------------------------------------------
+// Random openings of files of different sizes with a small budget,
+// compared with a model of the cache: the least recently opened files are
+// removed first, and a file larger than the budget is not cached
+int Evict(const vector<string> &Files, int Openings)
+{
+	int Failures = 0;
+
+	// the size of the snapshot of every file
+	vector<size_t> Sizes;
+	size_t Total = 0;
+	for(size_t i = 0; i < Files.size(); i++)
+	{
+		string Text;
+		int Keys = 1 + Random() % 200;
+		for(int k = 0; k < Keys; k++)
+			Text += "[s" + to_string(k % 7) + "]\nkey_" + to_string(k) + " = " + to_string(Random()) + "\n";
+		Save(Files[i], Text);
+
+		INICache Probe;
+		Sizes.push_back(Probe.Open(Files[i].c_str())->Size());
+		Total += Sizes.back();
+	}
+	size_t Largest = *max_element(Sizes.begin(), Sizes.end());
+
+	INICache Cache(Total / 3);
+	list<size_t> Model;
+	size_t ModelSize = 0;
+	vector<shared_ptr<const INISnapshot>> Last(Files.size());
+	for(int o = 0; o < Openings && Failures == 0; o++)
+	{
+		// the budget changes sometimes, down to less than the largest file
+		if(Random() % 50 == 0)
+		{
+			size_t Budget = (Random() % 2) ? Largest - 1 : Total / (1 + Random() % 4);
+			Cache.SetBudget(Budget);
+			while(ModelSize > Budget)
+			{
+				ModelSize -= Sizes[Model.back()];
+				Model.pop_back();
+			}
+		}
+
+		size_t i = Random() % Files.size();
+		list<size_t>::iterator m = find(Model.begin(), Model.end(), i);
+		bool Hit = (m != Model.end());
+		if(Hit)
+			Model.erase(m);
+		if(Hit || Sizes[i] <= Cache.GetBudget())
+		{
+			Model.push_front(i);
+			if(!Hit)
+				ModelSize += Sizes[i];
+			while(ModelSize > Cache.GetBudget())
+			{
+				ModelSize -= Sizes[Model.back()];
+				Model.pop_back();
+			}
+		}
+
+		shared_ptr<const INISnapshot> s = Cache.Open(Files[i].c_str());
+		if(!s || (s == Last[i]) != Hit || Cache.GetCount() != Model.size() || Cache.GetSize() != ModelSize
+			|| Cache.GetSize() > Cache.GetBudget())
+		{
+			cout << "opening " << o << " of file " << i << (Hit ? " (cached)" : "") << " : " << Cache.GetCount() << " files, "
+				<< Cache.GetSize() << " bytes, expected " << Model.size() << " files, " << ModelSize << " bytes" << endl;
+			Failures++;
+		}
+		Last[i] = s;
+	}
+
+	return Failures;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Openings = (argc > 1) ? atoi(argv[1]) : 5000;
+	int Failures = 0;
+
+	Failures += Stale("./ini_files/cache_test.ini");
+
+	vector<string> Files;
+	for(int i = 0; i < 8; i++)
+		Files.push_back("./ini_files/cache_test_" + to_string(i) + ".ini");
+	Failures += Evict(Files, Openings);
+	for(const string &File : Files)
+		remove(File.c_str());
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,64 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <string>
+#include <string.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+#include "INISnapshot.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+
+void DisplayUsage()
+{
+	cout << "Usage : inicompile file.ini [file.inic]" << endl;
+	cout << "        compile an INI file (into file.inic by default)" << endl;
+	cout << "        inicompile -t file.inic [file.ini]" << endl;
+	cout << "        check a compiled file (and that it is not stale)" << endl;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	if(argc >= 3 && strcmp(argv[1], "-t") == 0)
+	{
+		const char *Source = (argc > 3) ? argv[3] : NULL;
+		shared_ptr<const INISnapshot> Image = INISnapshot::Open(argv[2], Source, true);
+		if(Image == NULL)
+		{
+			cout << argv[2] << " : invalid or stale" << endl;
+			return 1;
+		}
+
+		cout << argv[2] << " : " << Image->GetSectionNumber() << " sections, "
+			 << Image->Size() << " bytes" << endl;
+		return 0;
+	}
+
+	if(argc < 2 || argc > 3 || argv[1][0] == '-')
+	{
+		DisplayUsage();
+		return 2;
+	}
+
+	INIParser Parser;
+	if(!Parser.Open(argv[1]))
+	{
+		cout << "Error : cannot open " << argv[1] << endl;
+		return 1;
+	}
+
+	string Output = (argc > 2) ? string(argv[2]) : string(argv[1]) + "c";
+	if(!Parser.Compile(Output.c_str()))
+	{
+		cout << "Error : cannot compile " << argv[1] << " into " << Output << endl;
+		return 1;
+	}
+
+	cout << argv[1] << " compiled into " << Output << endl;
+	return 0;
+}
+//---------------------------------------------------------------------------
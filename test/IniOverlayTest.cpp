@@ -0,0 +1,231 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma hdrstop
+
+#include "INIOverlay.h"
+#include "IniAllocCounter.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Random layer: a few sections and keys shared by the layers, declared
+// again in the same file, with comments and invalid lines
+string Generate(int Layer)
+{
+	static const char *Junk[] = {"# c", "junk", "", "[]", "=x"};
+
+	string Text;
+	int Sections = Random() % 6;
+	for(int s = 0; s < Sections; s++)
+	{
+		Text += "[s" + to_string(Random() % 5) + "]" + ((Random() % 3) ? "" : " ; l" + to_string(Layer)) + "\n";
+		int Keys = Random() % 6;
+		for(int k = 0; k < Keys; k++)
+		{
+			if(Random() % 6 == 0)
+				Text += Junk[Random() % 5];
+			else
+				Text += "k" + to_string(Random() % 6) + " = " + to_string(Layer * 1000 + Random() % 1000);
+			Text += "\n";
+		}
+	}
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Write a file
+void Save(const string &File, const string &Text)
+{
+	ofstream f(File.c_str(), ios::out | ios::binary);
+	f << Text;
+}
+
+//---------------------------------------------------------------------------
+// Compare the merged index with the layers parsed one by one: a key comes
+// from the last layer declaring it, and the sections and the keys are in
+// the order of their first declaration
+int Compare(INIOverlay &Overlay, const vector<string> &Files, const vector<char> &Exists)
+{
+	vector<unique_ptr<INIParser>> Layers;
+	for(size_t l = 0; l < Files.size(); l++)
+		Layers.push_back(unique_ptr<INIParser>(new INIParser(Exists[l] ? Files[l].c_str() : NULL)));
+
+	vector<string> Sections;
+	map<string, vector<string>> Keys;
+	map<string, int> SectionLayer;
+	map<pair<string, string>, int> KeyLayer;
+	for(size_t l = 0; l < Layers.size(); l++)
+		for(const sectionview &s : Layers[l]->GetSections())
+		{
+			string sec(s.key);
+			if(SectionLayer.count(sec) == 0)
+				Sections.push_back(sec);
+			SectionLayer[sec] = l;
+			for(const parameterview &p : Layers[l]->GetParameters(s))
+			{
+				pair<string, string> k(sec, string(p.name));
+				if(KeyLayer.count(k) == 0)
+					Keys[sec].push_back(k.second);
+				KeyLayer[k] = l;
+			}
+		}
+
+	int Failures = 0;
+	if(Overlay.GetSectionsName() != Sections || Overlay.GetLayerNumber() != (int)Files.size())
+		Failures++;
+	for(size_t l = 0; l < Files.size(); l++)
+	{
+		if(Overlay.IsLoaded(l) != (Exists[l] != 0) || Overlay.GetLayer(l)->GetSectionNumber() != Layers[l]->GetSectionNumber())
+			Failures++;
+	}
+
+	for(const string &sec : Sections)
+	{
+		INIParser &L = *(Layers[SectionLayer[sec]]);
+		section s = Overlay.GetSection(sec.c_str());
+		if(s.key != sec || s.comment != L.Find(sec)->comment || s.line != L.GetLineNumber(L.Find(sec)->handle)
+			|| s.parameters.size() != Keys[sec].size())
+		{
+			Failures++;
+			continue;
+		}
+
+		for(size_t i = 0; i < s.parameters.size(); i++)
+		{
+			const string &key = Keys[sec][i];
+			int l = KeyLayer[make_pair(sec, key)];
+			INIParser &P = *(Layers[l]);
+			const parameterview *p = P.Find(sec, key);
+			const overlayparam *o = Overlay.Find(sec, key);
+			int Line = -1;
+			if(s.parameters[i].name != key || s.parameters[i].value != p->value || o == NULL || o->layer != l
+				|| Overlay.GetLayer(l)->Find(sec, key)->value != p->value
+				|| Overlay.GetSource(sec.c_str(), key.c_str(), &Line) != Files[l] || Line != P.GetLineNumber(p->handle)
+				|| Overlay.GetString(sec.c_str(), key.c_str()) != string(p->value)
+				|| Overlay.GetInteger(sec.c_str(), key.c_str()) != P.GetInteger(sec.c_str(), key.c_str()))
+				Failures++;
+		}
+	}
+	if(Overlay.Find("s9", "k0") != NULL || Overlay.GetSource("s0", "k9") != "")
+		Failures++;
+
+	return Failures;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Runs = (argc > 1) ? atoi(argv[1]) : 500;
+	int Failures = 0;
+
+	// random layers, some of them missing, parsed by 1 to 4 threads
+	vector<string> Names;
+	for(int l = 0; l < 6; l++)
+		Names.push_back("./ini_files/overlay_test_" + to_string(l) + ".ini");
+	for(int r = 0; r < Runs; r++)
+	{
+		size_t n = 1 + Random() % 6;
+		vector<string> Files(Names.begin(), Names.begin() + n);
+		vector<char> Exists(n, 1);
+		bool All = true;
+		for(size_t l = 0; l < n; l++)
+		{
+			remove(Files[l].c_str());
+			if(Random() % 8 == 0)
+			{
+				Exists[l] = 0;
+				All = false;
+			}
+			else
+				Save(Files[l], Generate(l));
+		}
+
+		INIOverlay Overlay;
+		bool Opened = Overlay.Open(Files, (Random() % 2) ? INI_MAPPED : INI_DEFAULT, 1 + Random() % 4);
+		int f = Compare(Overlay, Files, Exists);
+		if(Opened != All || f != 0)
+		{
+			cout << "run " << r << " : " << f << " differences" << endl;
+			Failures++;
+			break;
+		}
+	}
+
+	// every allocation of the opening fails in turn: a layer whose parsing
+	// throws an exception is empty, the other ones are merged and Open()
+	// returns false (an allocation of Open() itself throws the exception)
+	{
+		vector<string> Files(Names.begin(), Names.begin() + 4);
+		for(size_t l = 0; l < Files.size(); l++)
+			Save(Files[l], Generate(l) + "[s0]\nk0 = " + to_string(l) + "\n");
+
+		int Interrupted = 0;
+		for(unsigned int Threads = 1; Threads <= 3; Threads += 2)
+			for(long long n = 1; ; n++)
+			{
+				INIOverlay Overlay;
+				bool Opened = false, Thrown = false;
+				FailedAllocation.store(n);
+				try
+				{
+					Opened = Overlay.Open(Files, INI_DEFAULT, Threads);
+				}
+				catch(const bad_alloc &)
+				{
+					Thrown = true;
+				}
+				if(FailedAllocation.exchange(0) > 0)
+					break;
+				if(Thrown)
+					continue;
+
+				vector<char> Exists(Files.size());
+				bool All = true;
+				for(size_t l = 0; l < Files.size(); l++)
+				{
+					Exists[l] = Overlay.IsLoaded(l);
+					All = All && Exists[l];
+				}
+				if(!All)
+					Interrupted++;
+				int f = Compare(Overlay, Files, Exists);
+				if(Opened != All || f != 0)
+				{
+					cout << "allocation " << n << " failed, " << Threads << " threads : " << f << " differences" << endl;
+					Failures++;
+					break;
+				}
+			}
+		if(Interrupted == 0)
+			Failures++;
+	}
+
+	for(const string &File : Names)
+		remove(File.c_str());
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,95 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <string>
+#include <vector>
+#include <atomic>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+#include "IniAllocCounter.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Check that the read path does not allocate once the file is opened
+bool CheckFile(const char *File, int Flags, const char *Name)
+{
+	INIParser Parser;
+	if(!Parser.Open(File, Flags))
+	{
+		cout << File << " (" << Name << ") : cannot be opened" << endl;
+		return false;
+	}
+
+	// the names are copied before counting, the views are checked after
+	vector<pair<string, string>> Keys;
+	for(const sectionview &s : Parser.GetSections())
+	{
+		Keys.push_back(make_pair(string(s.key), string()));
+		for(const parameterview &p : Parser.GetParameters(s))
+			Keys.push_back(make_pair(string(s.key), string(p.name)));
+	}
+	if(Keys.empty())
+	{
+		cout << File << " (" << Name << ") : no section" << endl;
+		return false;
+	}
+
+	size_t Found = 0;
+	size_t Sink = 0;
+	unsigned long long Before = Allocations.load();
+	for(int Run = 0; Run < 100; Run++)
+	{
+		for(size_t k = 0; k < Keys.size(); k++)
+		{
+			const string &Section = Keys[k].first;
+			const string &Key = Keys[k].second;
+			if(Key.empty())
+			{
+				Found += Parser.Find(Section) != NULL;
+				Found += Parser.Find(Section, "missing key") == NULL;
+				for(const parameterview &p : Parser.GetParameters(Section))
+					Sink += p.value.size();
+			}
+			else
+			{
+				Found += Parser.Find(Section, Key) != NULL;
+				Sink += Parser.GetStringView(Section, Key).size();
+			}
+		}
+		Found += Parser.Find("missing section") == NULL;
+		Sink += Parser.GetStringView("missing section", "missing key").size();
+		for(const sectionview &s : Parser.GetSections())
+			Sink += s.key.size();
+	}
+	unsigned long long Count = Allocations.load() - Before;
+
+	// two lookups by section, one by parameter and one missing section
+	size_t Expected = 100 * (Keys.size() + Parser.GetSections().size() + 1);
+
+	cout << File << " (" << Name << ") : " << Keys.size() << " keys, "
+		 << Count << " allocations" << endl;
+	if(Found != Expected)
+	{
+		cout << "  " << Expected - Found << " lookups failed" << endl;
+		return false;
+	}
+
+	return Count == 0 && Sink > 0;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	const char *File = (argc > 1) ? argv[1] : "./ini_files/test.ini";
+
+	bool Success = true;
+	Success &= CheckFile(File, INI_DEFAULT, "default");
+	Success &= CheckFile(File, INI_MAPPED, "mapped");
+	Success &= CheckFile(File, INI_ARENA, "arena");
+	Success &= CheckFile(File, INI_PARALLEL, "parallel");
+
+	cout << (Success ? "OK" : "FAILED") << endl;
+	return Success ? 0 : 1;
+}
@@ -0,0 +1,199 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <deque>
+#include <thread>
+#include <atomic>
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma hdrstop
+
+#include "INIAsync.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Executor which keeps the functions, run later by the thread of the test
+// (like an event loop)
+struct queue
+{
+	deque<function<void()>> Jobs;
+
+	INIExecutor Executor()
+	{
+		return [this](function<void()> Job) { this->Jobs.push_back(move(Job)); };
+	}
+
+	void Run()
+	{
+		while(!this->Jobs.empty())
+		{
+			function<void()> Job = move(this->Jobs.front());
+			this->Jobs.pop_front();
+			Job();
+		}
+	}
+};
+
+#ifdef INI_COROUTINES
+//---------------------------------------------------------------------------
+// Coroutine started at once and never awaited
+struct detached
+{
+	struct promise_type
+	{
+		detached get_return_object() { return detached(); }
+		suspend_never initial_suspend() { return suspend_never(); }
+		suspend_never final_suspend() noexcept { return suspend_never(); }
+		void return_void() {}
+		void unhandled_exception() { abort(); }
+	};
+};
+
+//---------------------------------------------------------------------------
+// Open a file in a coroutine, the result is given once it is resumed
+detached Await(INIOpenTask Task, INIParser *Parser, atomic<int> *Status, atomic<int> *Sections)
+{
+	INIOpenStatus s = co_await Task;
+	*Sections = (Parser != NULL) ? (int)Parser->GetSectionNumber() : -1;
+	*Status = s;
+}
+#endif
+
+//---------------------------------------------------------------------------
+// Check a result
+int Expect(const char *What, bool Success)
+{
+	if(!Success)
+		cout << What << " : failed" << endl;
+	return Success ? 0 : 1;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	const char *File = "./ini_files/test.ini";
+	int Failures = 0;
+	INIParser Reference(File);
+	size_t Sections = Reference.GetSectionNumber();
+
+	// opening by a new thread, then a missing file
+	{
+		INIParser Parser;
+		INIOpenTask Task = Parser.OpenAsync(File);
+		Failures += Expect("thread", Task.Wait() == INI_OPEN_DONE && Parser.GetSectionNumber() == Sections);
+
+		INIOpenTask Missing = Parser.OpenAsync("./ini_files/no_file.ini");
+		Failures += Expect("missing file", Missing.GetFuture().get() == INI_OPEN_FAILED && Missing.GetError() == ENOENT);
+	}
+
+	// a task cancelled before the executor runs it leaves the parser as it was
+	{
+		queue Queue;
+		INIParser Parser(File);
+		INIOpenTask Task = Parser.OpenAsync(File, INI_PARALLEL, Queue.Executor());
+		Failures += Expect("pending", Task.GetStatus() == INI_OPEN_PENDING);
+		Task.Cancel();
+		Queue.Run();
+		Failures += Expect("cancel", Task.Wait() == INI_OPEN_CANCELLED && Parser.GetSectionNumber() == Sections);
+
+		INIOpenTask Done = Parser.OpenAsync(File, INI_PARALLEL, Queue.Executor());
+		Queue.Run();
+		Failures += Expect("executor", Done.Wait() == INI_OPEN_DONE && Parser.GetSectionNumber() == Sections);
+	}
+
+	// the parser destroyed, or opening another file, before the executor runs
+	// the task: the thread running the executor must not wait for itself
+	{
+		queue Queue;
+		INIParser *Parser = new INIParser();
+		INIOpenTask Task = Parser->OpenAsync(File, INI_DEFAULT, Queue.Executor());
+		delete Parser;
+		Failures += Expect("destroyed", Task.GetStatus() == INI_OPEN_CANCELLED);
+		Queue.Run();
+		Failures += Expect("destroyed then run", Task.Wait() == INI_OPEN_CANCELLED);
+
+		INIParser Other;
+		INIOpenTask First = Other.OpenAsync("./ini_files/test2.ini", INI_DEFAULT, Queue.Executor());
+		INIOpenTask Second = Other.OpenAsync(File, INI_DEFAULT, Queue.Executor());
+		Failures += Expect("replaced", First.GetStatus() == INI_OPEN_CANCELLED && Queue.Jobs.size() == 2);
+		Queue.Run();
+		Failures += Expect("replacing", Second.Wait() == INI_OPEN_DONE && Other.GetSectionNumber() == Sections);
+	}
+
+	// an executor which drops the function, or throws an exception
+	{
+		INIParser Parser;
+		INIOpenTask Dropped = Parser.OpenAsync(File, INI_DEFAULT, [](function<void()>) {});
+		Failures += Expect("dropped", Dropped.Wait() == INI_OPEN_CANCELLED);
+
+		INIOpenTask Thrown = Parser.OpenAsync(File, INI_DEFAULT, [](function<void()>) { throw runtime_error("full"); });
+		Failures += Expect("thrown", Thrown.Wait() == INI_OPEN_FAILED && Thrown.GetError() == EAGAIN);
+	}
+
+	// cancellations racing with the threads: a task is either done with the
+	// file or cancelled without file
+	int Bad = 0;
+	for(int i = 0; i < 200; i++)
+	{
+		INIParser Parser;
+		INIOpenTask Task = Parser.OpenAsync(File);
+		if(i % 2)
+			Task.Cancel();
+		INIOpenStatus s = Task.Wait();
+		if((s == INI_OPEN_DONE && Parser.GetSectionNumber() != Sections) || (s == INI_OPEN_CANCELLED && Parser.GetSectionNumber() != 0)
+			|| (s != INI_OPEN_DONE && s != INI_OPEN_CANCELLED))
+			Bad++;
+	}
+	for(int i = 0; i < 200; i++)
+	{
+		INIParser *Parser = new INIParser();
+		INIOpenTask Task = Parser->OpenAsync(File);
+		delete Parser;
+		if(Task.GetStatus() == INI_OPEN_PENDING)
+			Bad++;
+	}
+	Failures += Expect("cancellations", Bad == 0);
+
+#ifdef INI_COROUTINES
+	// the coroutine is resumed by the thread which runs the task
+	{
+		queue Queue;
+		INIParser Parser;
+		atomic<int> Status(-1), Count(-1);
+		Await(Parser.OpenAsync(File, INI_DEFAULT, Queue.Executor()), &Parser, &Status, &Count);
+		Failures += Expect("coroutine suspended", Status.load() == -1);
+		Queue.Run();
+		Failures += Expect("coroutine", Status.load() == INI_OPEN_DONE && Count.load() == (int)Sections);
+
+		// a task already done does not suspend the coroutine
+		INIOpenTask Done = Parser.OpenAsync(File);
+		Done.Wait();
+		Await(Done, &Parser, &Status, &Count);
+		Failures += Expect("coroutine ready", Status.load() == INI_OPEN_DONE);
+
+		// a new thread resumes the coroutine
+		Status = -1;
+		Await(Parser.OpenAsync("./ini_files/no_file.ini"), NULL, &Status, &Count);
+		while(Status.load() == -1)
+			this_thread::yield();
+		Failures += Expect("coroutine failed", Status.load() == INI_OPEN_FAILED);
+
+		// the destroyed parser resumes the coroutine at once
+		INIParser *Other = new INIParser();
+		Status = -1;
+		Await(Other->OpenAsync(File, INI_DEFAULT, Queue.Executor()), NULL, &Status, &Count);
+		delete Other;
+		Failures += Expect("coroutine cancelled", Status.load() == INI_OPEN_CANCELLED);
+		Queue.Run();
+	}
+#else
+	cout << "the coroutines are not tested (C++20 is needed)" << endl;
+#endif
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
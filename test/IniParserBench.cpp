@@ -0,0 +1,400 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <atomic>
+#include <memory>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+#include "INICache.h"
+#include "IniAllocCounter.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Shape of a generated INI file
+struct corpus
+{
+	string name;
+	int sections;
+	int keys;
+	int comments;    // percentage of comment lines
+	int length;      // length of the string values
+	bool crlf;
+};
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Name of a section and of a key of the corpus
+string SectionName(int i)
+{
+	return "section" + to_string(i);
+}
+
+string KeyName(int j)
+{
+	return "key" + to_string(j);
+}
+
+//---------------------------------------------------------------------------
+// Write the INI text of a corpus: the keys are integers, doubles, booleans
+// and strings in turn
+string Generate(const corpus &c)
+{
+	const char *eol = c.crlf ? "\r\n" : "\n";
+	string Text;
+
+	Seed = 2463534242U;
+	for(int i = 0; i < c.sections; i++)
+	{
+		Text += "[" + SectionName(i) + "]";
+		Text += eol;
+		for(int j = 0; j < c.keys; j++)
+		{
+			if((int)(Random() % 100) < c.comments)
+			{
+				Text += "# comment of " + KeyName(j);
+				Text += eol;
+			}
+
+			Text += KeyName(j) + " = ";
+			switch(j % 4)
+			{
+				case 0: Text += to_string((int)(Random() % 100000)); break;
+				case 1: Text += to_string(Random() % 100000) + "." + to_string(Random() % 1000); break;
+				case 2: Text += (Random() % 2) ? "true" : "false"; break;
+				default: Text += string(c.length, (char)('a' + Random() % 26)); break;
+			}
+			if((int)(Random() % 100) < c.comments)
+				Text += " ; inline comment";
+			Text += eol;
+		}
+	}
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Run a benchmark and print one JSON line: the operation is repeated until
+// the time is long enough, bytes is the size processed by one operation
+template<class F> void Measure(const corpus &c, const char *name, long long ops, size_t bytes, F Run)
+{
+	long long runs = 0;
+	double seconds = 0;
+	unsigned long long allocs = 0;
+
+	Run();
+	do
+	{
+		unsigned long long a = Allocations.load(memory_order_relaxed);
+		chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+		Run();
+		chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+		allocs += Allocations.load(memory_order_relaxed) - a;
+		seconds += chrono::duration<double>(t1 - t0).count();
+		runs++;
+	}
+	while(seconds < 0.2 && runs < 1000);
+
+	double total = (double)runs * ops;
+	char line[512];
+	snprintf(line, sizeof(line),
+		"{\"bench\":\"%s\",\"corpus\":\"%s\",\"sections\":%d,\"keys\":%d,\"comments\":%d,\"length\":%d,\"crlf\":%s,"
+		"\"ops\":%.0f,\"ns_per_op\":%.2f,\"mb_per_s\":%.2f,\"allocs_per_op\":%.3f}",
+		name, c.name.c_str(), c.sections, c.keys, c.comments, c.length, c.crlf ? "true" : "false",
+		total, seconds * 1e9 / total, bytes ? (double)bytes * runs / seconds / 1e6 : 0.0, allocs / total);
+	cout << line << endl;
+}
+
+//---------------------------------------------------------------------------
+void RunCorpus(const corpus &c, const string &File)
+{
+	string Text = Generate(c);
+	{
+		ofstream f(File.c_str(), ios::out | ios::binary);
+		f << Text;
+	}
+
+	long long nkeys = (long long)c.sections * c.keys;
+	vector<string> Sections, Keys;
+	for(int i = 0; i < c.sections; i++)
+		Sections.push_back(SectionName(i));
+	for(int j = 0; j < c.keys; j++)
+		Keys.push_back(KeyName(j));
+
+	// random order of the keys for the cold lookups
+	vector<pair<int, int>> Order;
+	for(int i = 0; i < c.sections; i++)
+	{
+		for(int j = 0; j < c.keys; j++)
+			Order.push_back(make_pair(i, j));
+	}
+	for(size_t k = Order.size(); k > 1; k--)
+		swap(Order[k - 1], Order[Random() % k]);
+
+	volatile long long sink = 0;
+
+	Measure(c, "open", 1, Text.size(), [&]()
+	{
+		INIParser Parser(File.c_str());
+		sink += Parser.GetSectionNumber();
+	});
+
+	Measure(c, "open_mapped", 1, Text.size(), [&]()
+	{
+		INIParser Parser(File.c_str(), INI_MAPPED);
+		sink += Parser.GetSectionNumber();
+	});
+
+	Measure(c, "open_parallel", 1, Text.size(), [&]()
+	{
+		INIParser Parser(File.c_str(), INI_PARALLEL);
+		sink += Parser.GetSectionNumber();
+	});
+
+	Measure(c, "open_intern", 1, Text.size(), [&]()
+	{
+		INIParser Parser(File.c_str(), INI_INTERN);
+		sink += Parser.GetSectionNumber();
+	});
+
+	// an unchanged file opened again through the cache of the process
+	Measure(c, "open_cached", 1, Text.size(), [&]()
+	{
+		shared_ptr<const INISnapshot> s = INICache::Global().Open(File.c_str());
+		sink += s->GetSectionNumber();
+	});
+	INICache::Global().Clear();
+
+	// every key once in a random order, on a parser opened for this run
+	{
+		INIParser *Parser = NULL;
+		Measure(c, "lookup_cold", nkeys, 0, [&]()
+		{
+			delete Parser;
+			Parser = new INIParser(File.c_str());
+			for(size_t k = 0; k < Order.size(); k++)
+				sink += Parser->Find(Sections[Order[k].first], Keys[Order[k].second]) != NULL;
+		});
+		delete Parser;
+	}
+
+	INIParser Parser(File.c_str());
+
+	// the same few keys again and again
+	Measure(c, "lookup_warm", 100000, 0, [&]()
+	{
+		for(int k = 0; k < 100000; k++)
+			sink += Parser.Find(Sections[k % 4 % c.sections], Keys[k % 8 % c.keys]) != NULL;
+	});
+
+	INIKey Hot[8];
+	for(int k = 0; k < 8; k++)
+		Hot[k] = Parser.Resolve(Sections[0].c_str(), Keys[k % c.keys].c_str());
+	Measure(c, "lookup_resolved", 100000, 0, [&]()
+	{
+		for(int k = 0; k < 100000; k++)
+			sink += Parser.Find(Hot[k % 8]) != NULL;
+	});
+
+	Measure(c, "get_string", nkeys, 0, [&]()
+	{
+		for(size_t k = 0; k < Order.size(); k++)
+			sink += Parser.GetString(Sections[Order[k].first].c_str(), Keys[Order[k].second].c_str()).size();
+	});
+
+	Measure(c, "get_view", nkeys, 0, [&]()
+	{
+		for(size_t k = 0; k < Order.size(); k++)
+			sink += Parser.GetStringView(Sections[Order[k].first], Keys[Order[k].second]).size();
+	});
+
+	// every section and parameter through the view ranges
+	Measure(c, "iterate", nkeys, 0, [&]()
+	{
+		INISectionRange r = Parser.GetSections();
+		for(const sectionview *s = r.begin(); s != r.end(); ++s)
+		{
+			for(const parameterview &p : Parser.GetParameters(*s))
+				sink += p.value.size();
+		}
+	});
+
+	Measure(c, "get_typed", nkeys, 0, [&]()
+	{
+		for(size_t k = 0; k < Order.size(); k++)
+		{
+			const char *s = Sections[Order[k].first].c_str();
+			const char *key = Keys[Order[k].second].c_str();
+			switch(Order[k].second % 4)
+			{
+				case 0: sink += Parser.GetInteger(s, key); break;
+				case 1: sink += (long long)Parser.GetDouble(s, key); break;
+				default: sink += Parser.GetBoolean(s, key); break;
+			}
+		}
+	});
+
+	// the keys of a section and of every section beginning with "key1"
+	Measure(c, "find_prefix", 1000, 0, [&]()
+	{
+		for(int k = 0; k < 1000; k++)
+		{
+			for(INIKeyCursor r = Parser.FindPrefix(Sections[k % c.sections], "key1"); !r.done(); r.next())
+				sink += r.parameter().value.size();
+		}
+	});
+
+	Measure(c, "find_all_prefix", 1, 0, [&]()
+	{
+		for(INIKeyCursor r = Parser.FindAllPrefix("key1"); !r.done(); r.next())
+			sink += r.parameter().value.size();
+	});
+
+	// the keys of the first section into typed variables, by one call
+	vector<long long> Integers(c.keys);
+	vector<double> Doubles(c.keys);
+	unique_ptr<bool[]> Booleans(new bool[c.keys]);
+	vector<string_view> Views(c.keys);
+	vector<INIQuery> Queries;
+	for(int j = 0; j < c.keys; j++)
+	{
+		switch(j % 4)
+		{
+			case 0: Queries.push_back(INIQuery(Sections[0], Keys[j], &Integers[j])); break;
+			case 1: Queries.push_back(INIQuery(Sections[0], Keys[j], &Doubles[j])); break;
+			case 2: Queries.push_back(INIQuery(Sections[0], Keys[j], &Booleans[j])); break;
+			default: Queries.push_back(INIQuery(Sections[0], Keys[j], &Views[j])); break;
+		}
+	}
+	Measure(c, "query", c.keys, 0, [&]()
+	{
+		sink += Parser.Query(Queries.data(), Queries.size());
+	});
+
+	Measure(c, "write_ini", 1, Text.size(), [&]()
+	{
+		ostringstream Out;
+		Parser.WriteINI(Out);
+		sink += Out.tellp();
+	});
+
+	dictionnary d = Parser.GetDictionnary();
+	Measure(c, "write_file", 1, Text.size(), [&]()
+	{
+		sink += Parser.WriteINI(&d, File.c_str());
+	});
+
+	// one value of the same size, patched into a new file, then in place
+	{
+		INIParser Writer(File.c_str());
+		string One = Writer.GetString(Sections[0].c_str(), Keys[0].c_str());
+		Measure(c, "set_one", 1, 0, [&]()
+		{
+			sink += Writer.SetValue(Sections[0].c_str(), Keys[0].c_str(), One);
+		});
+	}
+	{
+		INIParser Writer(File.c_str(), INI_INPLACE);
+		string One = Writer.GetString(Sections[0].c_str(), Keys[0].c_str());
+		Measure(c, "set_one_inplace", 1, 0, [&]()
+		{
+			sink += Writer.SetValue(Sections[0].c_str(), Keys[0].c_str(), One);
+		});
+	}
+
+	// the file is written once by EndUpdate()
+	Measure(c, "set_value", nkeys, 0, [&]()
+	{
+		INIUpdate Update(&Parser);
+		for(size_t k = 0; k < Order.size(); k++)
+			Parser.SetValue(Sections[Order[k].first].c_str(), Keys[Order[k].second].c_str(), (int)k);
+		Update.Commit();
+	});
+}
+
+//---------------------------------------------------------------------------
+void DisplayUsage()
+{
+	cout << "Usage : iniparserbench [-s sections] [-k keys] [-c comments%] [-l length] [-crlf]" << endl;
+	cout << "        without option, a set of small, medium and large files is measured" << endl;
+	cout << "        every benchmark prints one JSON line" << endl;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	vector<corpus> Corpora;
+	corpus c = {"custom", 100, 100, 10, 16, false};
+	bool custom = false;
+
+	for(int a = 1; a < argc; a++)
+	{
+		string o = argv[a];
+		if(o == "-crlf")
+		{
+			c.crlf = true;
+		}
+		else if(a + 1 < argc && (o == "-s" || o == "-k" || o == "-c" || o == "-l"))
+		{
+			int v = atoi(argv[++a]);
+			if(o == "-s") c.sections = v;
+			else if(o == "-k") c.keys = v;
+			else if(o == "-c") c.comments = v;
+			else c.length = v;
+		}
+		else
+		{
+			DisplayUsage();
+			return 1;
+		}
+		custom = true;
+	}
+
+	if(c.sections < 1 || c.keys < 1)
+	{
+		DisplayUsage();
+		return 1;
+	}
+
+	if(custom)
+	{
+		Corpora.push_back(c);
+	}
+	else
+	{
+		Corpora.push_back({"small", 10, 10, 10, 16, false});
+		Corpora.push_back({"medium", 100, 100, 10, 16, false});
+		Corpora.push_back({"medium_crlf", 100, 100, 10, 16, true});
+		Corpora.push_back({"medium_comments", 100, 100, 50, 16, false});
+		Corpora.push_back({"long_lines", 100, 100, 10, 256, false});
+		Corpora.push_back({"large", 1000, 200, 10, 16, false});
+	}
+
+	string File = "IniParserBench.ini";
+	for(size_t i = 0; i < Corpora.size(); i++)
+		RunCorpus(Corpora[i], File);
+	remove(File.c_str());
+
+	return 0;
+}
+//---------------------------------------------------------------------------
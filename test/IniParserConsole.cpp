@@ -43,6 +43,9 @@ char DisplayMenu()
 		cout << "  m. Modify some values" << endl;
 		cout << "  t. Display file text" << endl;
 	}
+#ifdef INI_STATS
+	cout << "  i. Display statistics" << endl;
+#endif
 
 	cout << "  q. Quit" << endl;
 
@@ -271,13 +274,23 @@ int main(int argc, char* argv[])
 
 			case 'm':
 			{
+				INIUpdate Update(Parser);
 				bool Success = Parser->SetValue("cle2", "param4", false);
 				Success = Parser->SetValue("cle2", "param5", 14);
 				Success = Parser->SetValue("cle2", "param6", "coucou");
 				Success = Parser->SetValue("cle2", "param7", 1258.512489736);
+				Success = Update.Commit();
+				break;
+			}
+
+#ifdef INI_STATS
+			case 'i':
+			{
+				Parser->WriteStats(cout);
 				break;
 			}
 
+#endif
 			case 'q':
 			{
 				delete Parser;
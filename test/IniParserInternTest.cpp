@@ -0,0 +1,255 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <memory>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+#include "INIInternPool.h"
+#include "IniAllocCounter.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Configuration of a tenant: the same sections and keys for every tenant
+// (a few of the last ones are optional), with its own values and comments
+string Tenant(int t)
+{
+	static const char *Sections[] = {"database", "cache", "http_server", "authentication", "logging", "rate_limits", "storage", "notifications"};
+	static const char *Keys[] = {"connection_timeout_ms", "max_pool_size", "retry_backoff_policy", "endpoint_hostname",
+		"tls_certificate_path", "enable_compression", "idle_eviction_interval", "read_replica_weight",
+		"request_queue_capacity", "health_check_path", "metrics_export_prefix", "circuit_breaker_threshold"};
+
+	string Text = "; tenant " + to_string(t) + "\n";
+	for(int s = 0; s < 8; s++)
+	{
+		Text += string("[") + Sections[s] + "]\n";
+		for(int r = 0; r < 4; r++)
+			for(int k = 0; k < 12; k++)
+			{
+				if(r > 0 && Random() % 10 == 0)
+					continue;
+				Text += string(Keys[k]) + "_" + to_string(r) + " = " + to_string(Random() % 10000);
+				if(Random() % 8 == 0)
+					Text += " # t" + to_string(t);
+				Text += "\n";
+			}
+	}
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Random INI text with duplicated sections and keys, malformed lines, blank
+// lines, text before the first section, mixed line breaks and no final line
+// break
+string Generate()
+{
+	static const char *Breaks[] = {"\n", "\r\n", "\r"};
+	static const char *Malformed[] = {"[x", "[]", "[ab] junk", "x [y]", "[a]=b", "  [ok]   ", "#[c]", ";[d]"};
+
+	string Text;
+	int Break = Random() % 4;
+	int Lines = Random() % 200;
+	for(int i = 0; i < Lines; i++)
+	{
+		int k = Random() % 100;
+		if(k < 10)
+		{
+			Text += "[s" + to_string(Random() % 8) + "]";
+			if(Random() % 3 == 0)
+				Text += " ; sc" + to_string(i);
+		}
+		else if(k < 15)
+			Text += Malformed[Random() % 8];
+		else if(k < 25)
+			Text += ((Random() % 2) ? "# comment " : "; c ") + to_string(i);
+		else if(k < 30)
+			;
+		else
+		{
+			Text += "k" + to_string(Random() % 20) + ((Random() % 2) ? " = " : "=") + "v" + to_string(Random() % 100);
+			if(Random() % 4 == 0)
+				Text += " # ic" + to_string(i);
+		}
+		Text += Breaks[Break < 3 ? Break : Random() % 3];
+	}
+	if(Random() % 2)
+		Text += "k1=last";
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Everything a program can read from a parser
+string Dump(INIParser &Parser)
+{
+	ostringstream Out;
+	const sectionview *Sections = Parser.GetSections().begin();
+	Out << Parser.GetSectionNumber() << " sections" << endl;
+	for(const sectionview &s : Parser.GetSections())
+	{
+		Out << "[" << s.key << "] " << s.comment << " line " << Parser.GetLineNumber(s.handle)
+			<< " found " << (Parser.Find(s.key) - Sections) << endl;
+		for(const parameterview &p : Parser.GetParameters(s))
+		{
+			const parameterview *f = Parser.Find(s.key, p.name);
+			Out << p.name << "=" << p.value << " " << p.comment << " line " << Parser.GetLineNumber(p.handle)
+				<< " found " << (f != NULL ? string(f->value) : string("-")) << endl;
+		}
+	}
+	Parser.WriteINI(Out);
+
+	return Out.str();
+}
+
+//---------------------------------------------------------------------------
+// Write a file
+void Save(const string &File, const string &Text)
+{
+	ofstream f(File.c_str(), ios::out | ios::binary);
+	f << Text;
+}
+
+//---------------------------------------------------------------------------
+// Heap kept by the parsers of all the tenant files opened with Flags
+long long Resident(const vector<string> &Files, int Flags)
+{
+	vector<unique_ptr<INIParser>> Parsers;
+	long long Before = AllocatedBytes.load();
+	for(size_t i = 0; i < Files.size(); i++)
+		Parsers.push_back(unique_ptr<INIParser>(new INIParser(Files[i].c_str(), Flags)));
+
+	return AllocatedBytes.load() - Before;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Tenants = (argc > 1) ? atoi(argv[1]) : 200;
+	INIInternPool &Pool = INIInternPool::Global();
+	int Failures = 0;
+
+	// the interned index is the same as the index of the text
+	string File = "./ini_files/intern_test.ini";
+	static const int Flags[] = {INI_INTERN, INI_INTERN | INI_MAPPED, INI_INTERN | INI_ARENA};
+	for(int i = 0; i < 500; i++)
+	{
+		Save(File, Generate());
+		INIParser Plain(File.c_str());
+		for(int Flag : Flags)
+		{
+			INIParser Interned(File.c_str(), Flag);
+			if(Dump(Plain) != Dump(Interned) || !Interned.TextFile.empty())
+			{
+				cout << "file " << i << ", flags " << Flag << " : different" << endl;
+				Failures++;
+			}
+		}
+	}
+	if(Pool.GetCount() != 0)
+	{
+		cout << Pool.GetCount() << " names left in the pool" << endl;
+		Failures++;
+	}
+
+	// the tenants share their names and keep less memory
+	vector<string> Files;
+	size_t Bytes = 0;
+	for(int t = 0; t < Tenants; t++)
+	{
+		string Text = Tenant(t);
+		Files.push_back("./ini_files/intern_test_" + to_string(t) + ".ini");
+		Save(Files.back(), Text);
+		Bytes += Text.size();
+	}
+	long long Plain = Resident(Files, INI_DEFAULT);
+	long long Interned = Resident(Files, INI_INTERN);
+	cout << Tenants << " tenants (" << Bytes << " bytes) : " << Plain << " bytes, " << Interned << " bytes interned" << endl;
+	if((Plain - Interned) * 4 < (long long)Bytes * 3)
+	{
+		cout << "the interned parsers do not save 3/4 of the size of the files" << endl;
+		Failures++;
+	}
+	if(Pool.GetCount() != 0)
+	{
+		cout << Pool.GetCount() << " names left in the pool" << endl;
+		Failures++;
+	}
+
+	{
+		INIParser A(Files[0].c_str(), INI_INTERN);
+		INIParser B(Files[1].c_str(), INI_INTERN);
+		const parameterview *a = A.Find("cache", "max_pool_size_0");
+		const parameterview *b = B.Find("cache", "max_pool_size_0");
+		string_view Key = Pool.Find("max_pool_size_0");
+		if(a == NULL || b == NULL || a->name.data() != b->name.data() || Key.data() != a->name.data()
+			|| A.Find("cache", Key) != a || A.Find("cache", string("max_pool_size_0")) != a)
+		{
+			cout << "the names are not shared" << endl;
+			Failures++;
+		}
+
+		// the new names are interned too, and the file is rewritten
+		A.SetValue("cache", "max_pool_size_0", "42");
+		A.SetValue("cache", "new_key", "1");
+		A.SetValue("new_section", "max_pool_size_0", "2");
+		INIParser Check(Files[0].c_str());
+		if(Dump(Check) != Dump(A) || A.Find("new_section", "max_pool_size_0")->name.data() != b->name.data())
+		{
+			cout << "SetValue() : different" << endl;
+			Failures++;
+		}
+	}
+	if(Pool.GetCount() != 0)
+	{
+		cout << Pool.GetCount() << " names left in the pool" << endl;
+		Failures++;
+	}
+
+	// the hash of the text tells whether the file has changed
+	{
+		string Text = Tenant(-1) + "[last]   \r\n  key =  value   ; comment\r\n";
+		Save(File, Text);
+		INIParser Parser(File.c_str(), INI_INTERN);
+		string Image = "./ini_files/intern_test.inic";
+		if(Parser.Refresh() || !Parser.Compile(Image.c_str()))
+		{
+			cout << "Refresh() or Compile() : the file has changed" << endl;
+			Failures++;
+		}
+		Save(File, Text + "other = 1\r\n");
+		INIParser Check(File.c_str());
+		if(!Parser.Refresh() || Dump(Parser) != Dump(Check))
+		{
+			cout << "Refresh() : the file has not changed" << endl;
+			Failures++;
+		}
+		remove(Image.c_str());
+	}
+
+	remove(File.c_str());
+	for(size_t i = 0; i < Files.size(); i++)
+		remove(Files[i].c_str());
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
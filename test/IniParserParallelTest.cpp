@@ -0,0 +1,130 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Random INI text large enough to be parsed by several threads, with
+// duplicated sections and keys, malformed lines, blank lines, text before
+// the first section, mixed line breaks and no final line break
+string Generate()
+{
+	static const char *Breaks[] = {"\n", "\r\n", "\r"};
+	static const char *Malformed[] = {"[x", "[]", "[ab] junk", "x [y]", "[a]=b", "  [ok]   ", "#[c]", ";[d]"};
+
+	string Text;
+	int Break = Random() % 4;
+	int Lines = 20000 + Random() % 40000;
+	int Sections = 0;
+	for(int i = 0; i < Lines; i++)
+	{
+		int k = Random() % 100;
+		if(k < 3)
+		{
+			Text += (Random() % 2) ? "  [s" : "[s";
+			Text += to_string(Random() % (Sections + 5)) + "]";
+			if(Random() % 3 == 0)
+				Text += " ; sc";
+			Sections++;
+		}
+		else if(k < 5)
+			Text += Malformed[Random() % 8];
+		else if(k < 10)
+			Text += ((Random() % 2) ? "# comment " : "; c ") + to_string(i);
+		else if(k < 13)
+			;
+		else if(k < 15)
+			Text += "  \t ";
+		else
+		{
+			Text += "k" + to_string(Random() % 300) + ((Random() % 2) ? " = " : "=") + "v" + to_string(Random());
+			if(Random() % 5 == 0)
+				Text += " # ic";
+		}
+		Text += Breaks[Break < 3 ? Break : Random() % 3];
+	}
+	if(Random() % 2)
+		Text += "k1=last";
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Everything a program can read from a parser
+string Dump(INIParser &Parser)
+{
+	ostringstream Out;
+	const sectionview *Sections = Parser.GetSections().begin();
+	Out << Parser.GetSectionNumber() << " sections" << endl;
+	for(const sectionview &s : Parser.GetSections())
+	{
+		Out << "[" << s.key << "] " << s.comment << " line " << Parser.GetLineNumber(s.handle)
+			<< " found " << (Parser.Find(s.key) - Sections) << endl;
+		for(const parameterview &p : Parser.GetParameters(s))
+		{
+			const parameterview *f = Parser.Find(s.key, p.name);
+			Out << p.name << "=" << p.value << " " << p.comment << " line " << Parser.GetLineNumber(p.handle)
+				<< " found " << (f != NULL ? string(f->value) : string("-")) << endl;
+		}
+	}
+
+	INIKey k = Parser.Resolve("s1", "k1");
+	Out << "resolved " << Parser.GetStringView(k) << endl;
+	Parser.WriteINI(Out);
+
+	return Out.str();
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Files = (argc > 1) ? atoi(argv[1]) : 12;
+	const char *File = "./ini_files/parallel_test.ini";
+	static const int Flags[] = {INI_DEFAULT, INI_MAPPED, INI_ARENA, INI_MAPPED | INI_ARENA};
+
+	int Failures = 0;
+	for(int i = 0; i < Files; i++)
+	{
+		string Text = Generate();
+		{
+			ofstream f(File, ios::out | ios::binary);
+			f << Text;
+		}
+
+		for(int Flag : Flags)
+		{
+			INIParser Sequential(File, Flag);
+			INIParser Parallel(File, Flag | INI_PARALLEL);
+			if(Dump(Sequential) != Dump(Parallel))
+			{
+				cout << "file " << i << " (" << Text.size() << " bytes), flags " << Flag << " : different" << endl;
+				Failures++;
+			}
+		}
+	}
+	remove(File);
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,206 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <set>
+#include <algorithm>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Random name of a few characters, so the names share their prefixes
+string Name()
+{
+	static const char Chars[] = "ab.z";
+
+	string n;
+	int Size = 1 + Random() % 4;
+	for(int i = 0; i < Size; i++)
+		n += Chars[Random() % 4];
+	return n;
+}
+
+//---------------------------------------------------------------------------
+// Random INI text: the sections and the keys are declared several times
+string Generate()
+{
+	string Text;
+	int Sections = Random() % 8;
+	for(int s = 0; s < Sections; s++)
+	{
+		Text += "[" + Name() + "]\n";
+		int Keys = Random() % 12;
+		for(int k = 0; k < Keys; k++)
+			Text += Name() + " = " + to_string(Random() % 100) + "\n";
+	}
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Random bound: a name, the beginning of a name, a name followed by other
+// characters, the empty name, or the names around all the other ones
+string Bound(const vector<string> &Names)
+{
+	static const char *Others[] = {"", "a", "b.", "zzzzz", "\x7f", "\xff", " ", "aaaaaaaa"};
+
+	switch(Random() % 5)
+	{
+		case 0:
+			return Others[Random() % 8];
+		case 1:
+			return Name();
+		default:
+		{
+			if(Names.empty())
+				return "";
+			string n = Names[Random() % Names.size()];
+			if(Random() % 3 == 0)
+				n = n.substr(0, Random() % (n.size() + 1));
+			else if(Random() % 3 == 0)
+				n += (Random() % 2) ? "a" : "\xff";
+			return n;
+		}
+	}
+}
+
+//---------------------------------------------------------------------------
+// Keys given by a cursor, each one must be the key found by Find()
+string Walk(INIParser &Parser, INIKeyCursor c)
+{
+	string Out;
+	size_t n = c.size();
+	for(; !c.done(); c.next())
+	{
+		string s(c.section().key), k(c.parameter().name);
+		Out += s + "/" + k + (Parser.Find(s, k) == &(c.parameter()) ? "" : "!") + " ";
+		n--;
+	}
+
+	return (n == 0) ? Out : Out + "(size)";
+}
+
+//---------------------------------------------------------------------------
+// Keys selected by brute force, sorted by section then name (BySection) or
+// by name then section
+string Select(const set<pair<string, string>> &Keys, bool BySection, const string &section, const string &from, const string &to, bool IsPrefix)
+{
+	vector<pair<string, string>> Found;
+	for(const pair<string, string> &k : Keys)
+	{
+		if(BySection && k.first != section)
+			continue;
+		bool In = IsPrefix ? k.second.compare(0, from.size(), from) == 0 : (k.second >= from && (to.empty() || k.second < to));
+		if(In)
+			Found.push_back(BySection ? k : make_pair(k.second, k.first));
+	}
+	sort(Found.begin(), Found.end());
+
+	string Out;
+	for(const pair<string, string> &k : Found)
+		Out += BySection ? k.first + "/" + k.second + " " : k.second + "/" + k.first + " ";
+	return Out;
+}
+
+//---------------------------------------------------------------------------
+// Compare the queries of a parser with the brute force on its keys
+int Check(INIParser &Parser, int Queries)
+{
+	set<pair<string, string>> Keys;
+	vector<string> Sections, Names;
+	for(const sectionview &s : Parser.GetSections())
+	{
+		Sections.push_back(string(s.key));
+		for(const parameterview &p : Parser.GetParameters(s))
+		{
+			Keys.insert(make_pair(string(s.key), string(p.name)));
+			Names.push_back(string(p.name));
+		}
+	}
+
+	int Failures = 0;
+	for(int q = 0; q < Queries; q++)
+	{
+		string section = (Sections.empty() || Random() % 5 == 0) ? Name() : Sections[Random() % Sections.size()];
+		string from = Bound(Names), to = Bound(Names);
+
+		// the bounds are swapped too, so some ranges end before they begin
+		if(Random() % 4 == 0)
+			swap(from, to);
+
+		string Got[4] = {Walk(Parser, Parser.FindPrefix(section, from)), Walk(Parser, Parser.FindRange(section, from, to)),
+			Walk(Parser, Parser.FindAllPrefix(from)), Walk(Parser, Parser.FindAllRange(from, to))};
+		string Expected[4] = {Select(Keys, true, section, from, to, true), Select(Keys, true, section, from, to, false),
+			Select(Keys, false, section, from, to, true), Select(Keys, false, section, from, to, false)};
+		for(int i = 0; i < 4; i++)
+		{
+			if(Got[i] != Expected[i])
+			{
+				cout << "query " << i << " [" << section << "] \"" << from << "\" \"" << to << "\" : " << Got[i] << endl
+					<< "expected : " << Expected[i] << endl;
+				Failures++;
+			}
+		}
+	}
+
+	return Failures;
+}
+
+//---------------------------------------------------------------------------
+// Write a file
+void Save(const char *File, const string &Text)
+{
+	ofstream f(File, ios::out | ios::binary);
+	f << Text;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Files = (argc > 1) ? atoi(argv[1]) : 300;
+	const char *File = "./ini_files/range_test.ini";
+	static const int Flags[] = {INI_DEFAULT, INI_INTERN, INI_PARALLEL};
+
+	int Failures = 0;
+	for(int i = 0; i < Files && Failures == 0; i++)
+	{
+		Save(File, Generate());
+		INIParser Parser(File, Flags[i % 3]);
+		Failures += Check(Parser, 50);
+
+		// the sorted index follows the new keys, and the reopened file
+		for(int k = 0; k < 3; k++)
+			Parser.SetValue(Name().c_str(), Name().c_str(), "new");
+		Failures += Check(Parser, 20);
+		Save(File, Generate());
+		Parser.Refresh();
+		Failures += Check(Parser, 20);
+	}
+
+	// the boundaries of an empty parser
+	INIParser Empty;
+	Failures += Check(Empty, 20);
+	remove(File);
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,200 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Random INI text: text before the first section, invalid lines, comments,
+// CRLF or mixed line breaks, and sometimes no final line break. With
+// Unique, the sections and the keys of a section are declared once, so
+// Refresh() parses only the changed sections; otherwise they are repeated.
+string Generate(bool Unique)
+{
+	static const char *Junk[] = {"# c", "junk", "", "  ", "k = v ; x", "=x", "[]", "[ab", " \t"};
+	static const char *Breaks[] = {"\n", "\r\n"};
+
+	string Text;
+	int Break = Random() % 3;
+	int Lines = Random() % 3;
+	for(int i = 0; i < Lines; i++)
+		Text += string(Junk[Random() % 9]) + Breaks[Break < 2 ? Break : Random() % 2];
+
+	int Sections = Random() % 10;
+	for(int s = 0; s < Sections; s++)
+	{
+		Text += "[s" + to_string(Unique ? s : Random() % 6) + "]" + ((Random() % 3) ? "" : " ; c");
+		Text += Breaks[Break < 2 ? Break : Random() % 2];
+		int Keys = Random() % 6;
+		for(int k = 0; k < Keys; k++)
+		{
+			if(Random() % 6 == 0)
+				Text += Junk[Random() % 9];
+			else
+			{
+				Text += "k" + to_string(Unique ? k : Random() % 6) + " = " + to_string(Random() % 100);
+				if(Random() % 4 == 0)
+					Text += " # z";
+			}
+			Text += Breaks[Break < 2 ? Break : Random() % 2];
+		}
+	}
+	if(Random() % 3 == 0 && !Text.empty())
+		Text.erase(Text.size() - ((Text.size() > 1 && Text[Text.size() - 2] == '\r') ? 2 : 1));
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Random edit of a text: characters erased, inserted or replaced, lines
+// added (sections declared again, keys, line breaks, text at the start),
+// values changed or the final line break removed
+string Mutate(string Text)
+{
+	static const char *Insert[] = {"x", "=", "[", "]", "\n", "#", ";", "k9 = 1\n", "[s9]\n", "[s1]\n", " ",
+		"k0 = q\n", "\r\n", "\r", "k1 = 7\r\n", "[s2] ; again\r\n"};
+
+	size_t n = Text.size();
+	size_t pos = (n > 0) ? Random() % n : 0;
+	switch(Random() % 9)
+	{
+		case 0:
+			if(n > 0)
+				Text.erase(pos, 1 + Random() % 5);
+			break;
+		case 1:
+			Text.insert(pos, Insert[Random() % 16]);
+			break;
+		case 2:
+			if(n > 0)
+				Text[pos] = Insert[Random() % 16][0];
+			break;
+		case 3:
+			Text.insert(pos, Generate(Random() % 2 == 0));
+			break;
+		case 4:
+			if(n > 0)
+				Text.replace(pos, Random() % (n - pos), to_string(Random() % 1000));
+			break;
+		case 5:
+			Text.insert(0, (Random() % 2) ? "before = 1\r\n" : "; header\n");
+			break;
+		case 6:
+			while(!Text.empty() && (Text.back() == '\n' || Text.back() == '\r'))
+				Text.pop_back();
+			break;
+		default:
+		{
+			size_t q = Text.find("= ", pos);
+			if(q != string::npos && q + 2 < n)
+				Text.replace(q + 2, 1, to_string(Random() % 10000));
+			break;
+		}
+	}
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Everything a program can read from a parser
+string Dump(INIParser &Parser)
+{
+	ostringstream Out;
+	const sectionview *Sections = Parser.GetSections().begin();
+	Out << Parser.GetSectionNumber() << " sections" << endl;
+	for(const sectionview &s : Parser.GetSections())
+	{
+		Out << "[" << s.key << "] " << s.comment << " line " << Parser.GetLineNumber(s.handle)
+			<< " found " << (Parser.Find(s.key) - Sections) << endl;
+		for(const parameterview &p : Parser.GetParameters(s))
+		{
+			const parameterview *f = Parser.Find(s.key, p.name);
+			string k(s.key), n(p.name);
+			Out << p.name << "=" << p.value << " " << p.comment << " line " << Parser.GetLineNumber(p.handle)
+				<< " found " << (f != NULL ? string(f->value) + " line " + to_string(Parser.GetLineNumber(f->handle)) : string("-"))
+				<< " " << Parser.GetInteger(k.c_str(), n.c_str()) << " " << Parser.GetDouble(k.c_str(), n.c_str()) << endl;
+		}
+	}
+	Parser.WriteINI(Out);
+
+	return Out.str();
+}
+
+//---------------------------------------------------------------------------
+// Write a file
+void Save(const char *File, const string &Text)
+{
+	ofstream f(File, ios::out | ios::binary);
+	f << Text;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Files = (argc > 1) ? atoi(argv[1]) : 1000;
+	const char *File = "./ini_files/reload_test.ini";
+	static const char *SectionNames[] = {"s0", "s1", "s2", "s9"};
+	static const char *KeyNames[] = {"k0", "k1", "k2", "k9"};
+
+	int Failures = 0;
+	for(int i = 0; i < Files && Failures < 10; i++)
+	{
+		string Text = Generate(i % 2 == 0);
+		Save(File, Text);
+		INIParser Parser(File);
+
+		// the resolved keys must follow the changes of the layout
+		vector<INIKey> Keys;
+		for(const char *s : SectionNames)
+			for(const char *k : KeyNames)
+				Keys.push_back(Parser.Resolve(s, k));
+
+		for(int Step = 0; Step < 12; Step++)
+		{
+			string New = (Step % 5 == 4) ? Text : Mutate(Text);
+			Save(File, New);
+			bool Changed = Parser.Refresh();
+
+			INIParser Reopened(File);
+			string Got = Dump(Parser), Expected = Dump(Reopened);
+			bool Same = (Got == Expected);
+			for(INIKey &k : Keys)
+				Same = Same && Parser.Find(k) == Parser.Find(k.section, k.key);
+
+			if(!Same || (New == Text && Changed))
+			{
+				cout << "file " << i << ", step " << Step << (Same ? " : changed" : " : different") << endl
+					<< "--- old" << endl << Text << endl << "--- new" << endl << New << endl
+					<< "--- refreshed" << endl << Got << "--- opened" << endl << Expected;
+				Failures++;
+				break;
+			}
+			Text = New;
+		}
+	}
+	remove(File);
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
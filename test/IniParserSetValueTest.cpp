@@ -0,0 +1,221 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Random INI text with repeated sections and keys, comments, invalid lines,
+// text before the first section, mixed line breaks and sometimes no final
+// line break
+string Generate()
+{
+	static const char *Junk[] = {"# c", "junk", "", "  ", "[]", "[ab", "=x"};
+	static const char *Breaks[] = {"\n", "\r\n"};
+
+	string Text;
+	int Break = Random() % 3;
+	int Lines = Random() % 3;
+	for(int i = 0; i < Lines; i++)
+		Text += string(Junk[Random() % 7]) + Breaks[Break < 2 ? Break : Random() % 2];
+
+	int Sections = 1 + Random() % 6;
+	for(int s = 0; s < Sections; s++)
+	{
+		Text += "[s" + to_string(Random() % 5) + "]" + ((Random() % 3) ? "" : " ; c");
+		Text += Breaks[Break < 2 ? Break : Random() % 2];
+		int Keys = Random() % 6;
+		for(int k = 0; k < Keys; k++)
+		{
+			if(Random() % 6 == 0)
+				Text += Junk[Random() % 7];
+			else
+			{
+				Text += "k" + to_string(Random() % 5) + ((Random() % 2) ? " = " : "=") + to_string(Random() % 1000);
+				if(Random() % 4 == 0)
+					Text += " # z";
+			}
+			Text += Breaks[Break < 2 ? Break : Random() % 2];
+		}
+	}
+	if(Random() % 3 == 0)
+		Text += "k9 = last";
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+// Random value: often of the size of the old one, so it can be written in
+// place, sometimes empty
+string Value(const string &Old)
+{
+	static const char Chars[] = "abcdefghijklmnopqrstuvwxyz0123456789_.";
+
+	size_t n = (Random() % 3 != 0) ? Old.size() : Random() % 12;
+	string v;
+	for(size_t i = 0; i < n; i++)
+		v += Chars[Random() % (sizeof(Chars) - 1)];
+	return v;
+}
+
+//---------------------------------------------------------------------------
+// Sections and parameters of a parser (a rewritten file loses its lines of
+// blanks, so the other lines are not compared)
+string Dump(INIParser &Parser)
+{
+	ostringstream Out;
+	Out << Parser.GetSectionNumber() << " sections" << endl;
+	for(const sectionview &s : Parser.GetSections())
+	{
+		Out << "[" << s.key << "] " << s.comment << endl;
+		for(const parameterview &p : Parser.GetParameters(s))
+			Out << p.name << "=" << p.value << " " << p.comment << endl;
+	}
+
+	return Out.str();
+}
+
+//---------------------------------------------------------------------------
+// Text of a file
+string Load(const char *File)
+{
+	ifstream f(File, ios::in | ios::binary);
+	ostringstream Out;
+	Out << f.rdbuf();
+	return Out.str();
+}
+
+//---------------------------------------------------------------------------
+// Write a file
+void Save(const char *File, const string &Text)
+{
+	ofstream f(File, ios::out | ios::binary);
+	f << Text;
+}
+
+//---------------------------------------------------------------------------
+// Random modifications of a file: the values of existing keys (patched
+// while no key is added) and new keys or sections (rewritten), one by one
+// or grouped by an update. After every step the file is parsed again and
+// must give the expected values and the index of the parser.
+int Run(const char *File, const char *Opened, int Flags, int Files)
+{
+	int Failures = 0;
+	for(int i = 0; i < Files && Failures == 0; i++)
+	{
+		string Text = Generate();
+		Save(File, Text);
+		INIParser Parser(Opened, Flags);
+
+		// the value of every key, the last declaration wins
+		map<pair<string, string>, string> Expected;
+		for(const sectionview &s : Parser.GetSections())
+			for(const parameterview &p : Parser.GetParameters(s))
+				Expected[make_pair(string(s.key), string(p.name))] = string(Parser.Find(s.key, p.name)->value);
+
+		for(int Step = 0; Step < 20 && Failures == 0; Step++)
+		{
+			int Count = (Random() % 4 == 0) ? 1 + Random() % 5 : 1;
+			INIUpdate Update(&Parser);
+			for(int c = 0; c < Count; c++)
+			{
+				string s, k;
+				if(Random() % 5 != 0 && !Expected.empty())
+				{
+					map<pair<string, string>, string>::iterator e = Expected.begin();
+					advance(e, Random() % Expected.size());
+					s = e->first.first;
+					k = e->first.second;
+				}
+				else
+				{
+					s = "s" + to_string(Random() % 7);
+					k = "n" + to_string(Random() % 7);
+				}
+
+				string v = Value(Expected[make_pair(s, k)]);
+				Parser.SetValue(s.c_str(), k.c_str(), v);
+				Expected[make_pair(s, k)] = v;
+			}
+			bool Written = Update.Commit();
+
+			INIParser Check(File);
+			bool Same = Written && Dump(Parser) == Dump(Check);
+			for(map<pair<string, string>, string>::iterator e = Expected.begin(); e != Expected.end() && Same; e++)
+			{
+				const parameterview *p = Check.Find(e->first.first, e->first.second);
+				Same = p != NULL && p->value == e->second;
+			}
+			if(!Same)
+			{
+				cout << "flags " << Flags << ", file " << i << ", step " << Step << " : different" << endl
+					<< "--- original" << endl << Text << endl << "--- written" << endl << Load(File) << endl;
+				Failures++;
+			}
+		}
+	}
+
+	return Failures;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Files = (argc > 1) ? atoi(argv[1]) : 100;
+	const char *File = "./ini_files/setvalue_test.ini";
+	const char *Link = "./ini_files/setvalue_link.ini";
+	static const int Flags[] = {INI_DEFAULT, INI_INPLACE, INI_MAPPED, INI_MAPPED | INI_INPLACE, INI_ARENA, INI_INTERN};
+
+	int Failures = 0;
+	for(int Flag : Flags)
+		Failures += Run(File, File, Flag, Files);
+
+	// a file opened through a symbolic link is written, the link is kept
+	unlink(Link);
+	if(symlink("setvalue_test.ini", Link) != 0)
+	{
+		cout << "cannot create the link" << endl;
+		Failures++;
+	}
+	else
+	{
+		for(int Flag : Flags)
+			Failures += Run(File, Link, Flag, Files / 10);
+
+		struct stat st;
+		if(lstat(Link, &st) != 0 || !S_ISLNK(st.st_mode))
+		{
+			cout << "the link has been replaced" << endl;
+			Failures++;
+		}
+	}
+	unlink(Link);
+	remove(File);
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <stdio.h>
+#include <stdlib.h>
+
+#pragma hdrstop
+
+#include "INISnapshot.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Compare the snapshot of a parser with the parser itself
+int Compare(const char *File)
+{
+	INIParser Parser(File, INI_SNAPSHOT);
+	shared_ptr<const INISnapshot> s = Parser.Snapshot();
+	if(!s)
+	{
+		cout << File << " : no snapshot" << endl;
+		return 1;
+	}
+
+	int Failures = 0;
+	if(Parser.GetSectionsName() != s->GetSectionsName())
+		Failures++;
+	dictionnary d = Parser.GetDictionnary();
+	for(const section &sec : d.sections)
+	{
+		section a = Parser.GetSection(sec.key.c_str());
+		section b = s->GetSection(sec.key.c_str());
+		if(a.line != b.line || a.comment != b.comment || a.parameters.size() != b.parameters.size())
+		{
+			Failures++;
+			continue;
+		}
+		for(size_t i = 0; i < a.parameters.size(); i++)
+		{
+			const parameter &x = a.parameters[i];
+			const parameter &y = b.parameters[i];
+			if(x.name != y.name || x.value != y.value || x.comment != y.comment || x.line != y.line)
+				Failures++;
+
+			const char *k = sec.key.c_str(), *n = x.name.c_str();
+			if(Parser.GetString(k, n) != s->GetString(k, n) || Parser.GetBoolean(k, n) != s->GetBoolean(k, n)
+				|| Parser.GetInteger(k, n) != s->GetInteger(k, n) || Parser.GetDouble(k, n) != s->GetDouble(k, n))
+				Failures++;
+		}
+	}
+	if(s->Find("no_section") != NULL || s->Find("no_section", "no_key") != NULL)
+		Failures++;
+
+	if(Failures > 0)
+		cout << File << " : " << Failures << " differences" << endl;
+	return Failures;
+}
+
+//---------------------------------------------------------------------------
+// Readers of the snapshots while the parser modifies and reopens the file:
+// x and y are always set together, so a snapshot where they differ has
+// been read while it was built
+int Concurrent(const char *File, int Updates)
+{
+	{
+		ofstream f(File, ios::out | ios::binary);
+		f << "[a]\nx = 0\ny = 0\n";
+	}
+
+	INIParser Parser(File, INI_SNAPSHOT);
+	atomic<bool> Stop(false);
+	atomic<long> Reads(0), Bad(0);
+
+	vector<thread> Threads;
+	for(int t = 0; t < 4; t++)
+		Threads.emplace_back([&, t]()
+		{
+			INISnapshotReader Reader(&Parser);
+			unsigned long Last = 0;
+			while(!Stop.load())
+			{
+				// half the threads copy the snapshot every time
+				shared_ptr<const INISnapshot> Copy;
+				const INISnapshot *s;
+				if(t % 2 == 0)
+					s = Reader.Get();
+				else
+				{
+					Copy = Parser.Snapshot();
+					s = Copy.get();
+				}
+
+				if(s == NULL || s->GetInteger("a", "x") != s->GetInteger("a", "y") || s->GetVersion() < Last)
+					Bad++;
+				else
+					Last = s->GetVersion();
+				Reads++;
+			}
+		});
+
+	for(int i = 1; i <= Updates; i++)
+	{
+		INIUpdate Update(&Parser);
+		Parser.SetValue("a", "x", i);
+		Parser.SetValue("a", "y", i);
+		Parser.SetValue("b", ("k" + to_string(i % 7)).c_str(), i);
+		Update.Commit();
+		if(i % 50 == 0)
+			Parser.Open(File, (i % 100 == 0) ? INI_SNAPSHOT | INI_ARENA : INI_SNAPSHOT);
+	}
+	Stop.store(true);
+	for(thread &t : Threads)
+		t.join();
+
+	shared_ptr<const INISnapshot> s = Parser.Snapshot();
+	if(Reads.load() == 0 || Bad.load() != 0 || s->GetVersion() != Parser.GetVersion() || s->GetInteger("a", "x") != Updates)
+	{
+		cout << "concurrent readers : " << Bad.load() << " bad reads of " << Reads.load() << endl;
+		return 1;
+	}
+
+	remove(File);
+	return 0;
+}
+
+//---------------------------------------------------------------------------
+int main(int argc, char* argv[])
+{
+	int Failures = 0;
+
+	Failures += Compare("./ini_files/test.ini");
+	Failures += Compare("./ini_files/test_old.ini");
+	Failures += Compare("./ini_files/test2.ini");
+	Failures += Concurrent("./ini_files/snapshot_test.ini", (argc > 1) ? atoi(argv[1]) : 300);
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+//---------------------------------------------------------------------------
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <stdio.h>
+
+#pragma hdrstop
+
+#include "INIParser.h"
+#include "INIStreamParser.h"
+
+using namespace std;
+
+//---------------------------------------------------------------------------
+// Handler writing every event as one line of text
+
+class EventHandler : public INIHandler
+{
+	public:
+		string Events;
+
+		bool OnSection(string_view key, string_view comment, size_t offset) override
+		{
+			this->Events += "S[" + string(key) + "|" + string(comment) + "]@" + to_string(offset) + "\n";
+			return true;
+		}
+
+		bool OnParameter(string_view section, string_view name, string_view value, string_view comment, size_t offset) override
+		{
+			this->Events += "P[" + string(section) + "|" + string(name) + "=" + string(value) + "|" + string(comment) + "]@" + to_string(offset) + "\n";
+			return true;
+		}
+
+		bool OnComment(string_view text, size_t offset) override
+		{
+			this->Events += "C[" + string(text) + "]@" + to_string(offset) + "\n";
+			return true;
+		}
+
+		bool OnError(string_view line, size_t offset) override
+		{
+			this->Events += "E[" + string(line) + "]@" + to_string(offset) + "\n";
+			return true;
+		}
+};
+
+//---------------------------------------------------------------------------
+// Events of a text parsed by chunks of a given size
+string Events(const string &Text, size_t ChunkSize, size_t MaxLine)
+{
+	INIStreamParser Parser(ChunkSize, MaxLine);
+	EventHandler Handler;
+	istringstream In(Text);
+	if(!Parser.Parse(In, Handler))
+		Handler.Events += "FAILED\n";
+
+	return Handler.Events;
+}
+
+//---------------------------------------------------------------------------
+// Deterministic random numbers (xorshift)
+static unsigned int Seed = 2463534242U;
+
+unsigned int Random()
+{
+	Seed ^= Seed << 13;
+	Seed ^= Seed >> 17;
+	Seed ^= Seed << 5;
+	return Seed;
+}
+
+//---------------------------------------------------------------------------
+// Random INI text with blank lines, comments, errors, CR LF and long lines
+string Generate(int MaxLength)
+{
+	string Text;
+	int n = Random() % 20;
+	for(int i = 0; i < n; i++)
+	{
+		string pad(Random() % 4, (Random() % 2) ? ' ' : '\t');
+		switch(Random() % 7)
+		{
+			case 0: Text += pad + "[sec" + to_string(Random() % 10) + "]"; break;
+			case 1: Text += pad + "key" + to_string(i) + " = " + string(Random() % MaxLength, 'v') + pad; break;
+			case 2: Text += "# c" + string(Random() % MaxLength, 'c'); break;
+			case 3: Text += string(Random() % 90, (Random() % 2) ? ' ' : '\t'); break;
+			case 4: Text += string(Random() % MaxLength, 'z'); break;
+			case 5: Text += pad + "a=b ; comment" + pad; break;
+			default: break;
+		}
+		Text += (Random() % 3 == 0) ? "\r\n" : "\n";
+	}
+
+	return Text;
+}
+
+//---------------------------------------------------------------------------
+int main()
+{
+	int Failures = 0;
+
+	// the lines of blanks are ignored as the empty ones
+	string Expected = "S[a|]@0\nP[a|k=1|]@5\nE[x]@15\n";
+	string Found = Events("[a]\n\nk=1\n   \n\t\nx\n", 4096, 4096);
+	if(Found != Expected)
+	{
+		cout << "blank lines: " << endl << Found;
+		Failures++;
+	}
+
+	// a long line is an error whatever the size of the chunks
+	string Long = "[s]\nk=" + string(300, 'x') + "\n";
+	Expected = "S[s|]@0\nE[k=" + string(62, 'x') + "]@4\n";
+	for(size_t ChunkSize : {4096, 16, 1})
+	{
+		if(Events(Long, ChunkSize, 64) != Expected)
+		{
+			cout << "long line, chunks of " << ChunkSize << ": " << endl << Events(Long, ChunkSize, 64);
+			Failures++;
+		}
+	}
+
+	// the events do not depend on the size of the chunks
+	int Differences = 0;
+	for(int i = 0; i < 2000; i++)
+	{
+		size_t MaxLine = 8 + Random() % 80;
+		string Text = Generate(100);
+		string Reference = Events(Text, 65536, MaxLine);
+		for(size_t ChunkSize : {1, 2, 3, 5, 7, 16, 33, 64})
+		{
+			if(Events(Text, ChunkSize, MaxLine) != Reference)
+			{
+				Differences++;
+				break;
+			}
+		}
+	}
+	if(Differences > 0)
+	{
+		cout << Differences << " texts depend on the size of the chunks" << endl;
+		Failures++;
+	}
+
+	// the sections and parameters are the ones of INIParser
+	const char *File = "./ini_files/stream_test.ini";
+	int Mismatches = 0;
+	for(int i = 0; i < 200; i++)
+	{
+		string Text = Generate(30);
+		{
+			ofstream f(File, ios::out | ios::binary);
+			f << Text;
+		}
+
+		string Reference;
+		INIParser Parser(File);
+		for(const sectionview &s : Parser.GetSections())
+		{
+			Reference += "S[" + string(s.key) + "]\n";
+			for(const parameterview &p : Parser.GetParameters(s))
+				Reference += "P[" + string(p.name) + "=" + string(p.value) + "]\n";
+		}
+
+		string Streamed;
+		istringstream Lines(Events(Text, 7, 4096));
+		string Line;
+		while(getline(Lines, Line))
+		{
+			if(Line[0] == 'S')
+				Streamed += "S[" + Line.substr(2, Line.find('|') - 2) + "]\n";
+			else if(Line[0] == 'P')
+			{
+				size_t a = Line.find('|') + 1;
+				size_t b = Line.find('|', a);
+				Streamed += "P[" + Line.substr(a, b - a) + "]\n";
+			}
+		}
+
+		if(Streamed != Reference)
+			Mismatches++;
+	}
+	remove(File);
+	if(Mismatches > 0)
+	{
+		cout << Mismatches << " texts differ from INIParser" << endl;
+		Failures++;
+	}
+
+	cout << (Failures == 0 ? "OK" : "FAILED") << endl;
+	return Failures == 0 ? 0 : 1;
+}